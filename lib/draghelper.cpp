@@ -9,12 +9,14 @@
 #include <QDrag>
 #include <QMimeData>
 #include <QQuickItem>
+#include <QQuickWindow>
 
 using namespace Milou;
 
 DragHelper::DragHelper(QObject *parent)
     : QObject(parent)
     , m_dragIconSize(32)
+    , m_pixmapCache(20)
 {
 }
 
@@ -47,22 +49,52 @@ void DragHelper::startDrag(QQuickItem *item, QMimeData *mimeData, const QIcon &i
     // the caller is destroyed mid-drag
     // clang-format off
     QMetaObject::invokeMethod(this, "doDrag", Qt::QueuedConnection,
-        Q_ARG(QQuickItem*, item), Q_ARG(QMimeData*, mimeData), Q_ARG(QIcon, icon));
+        Q_ARG(QQuickItem*, item), Q_ARG(QMimeData*, mimeData), Q_ARG(QIcon, icon), Q_ARG(QString, QString()));
     // clang-format on
 }
 
 void DragHelper::startDrag(QQuickItem *item, QMimeData *mimeData, const QString &iconName)
 {
-    startDrag(item, mimeData, QIcon::fromTheme(iconName));
+    // The icon is only looked up if it isn't cached already
+    // clang-format off
+    QMetaObject::invokeMethod(this, "doDrag", Qt::QueuedConnection,
+        Q_ARG(QQuickItem*, item), Q_ARG(QMimeData*, mimeData), Q_ARG(QIcon, QIcon()), Q_ARG(QString, iconName));
+    // clang-format on
+}
+
+QPixmap DragHelper::dragPixmap(QQuickItem *item, const QIcon &icon, const QString &iconName)
+{
+    QWindow *window = item ? item->window() : nullptr;
+    const qreal devicePixelRatio = window ? window->devicePixelRatio() : qApp->devicePixelRatio();
+
+    QString iconKey = iconName;
+    if (iconKey.isEmpty()) {
+        iconKey = !icon.name().isEmpty() ? icon.name() : QString::number(icon.cacheKey());
+    }
+    const QString key = iconKey + QLatin1Char('|') + QString::number(m_dragIconSize) + QLatin1Char('@') + QString::number(devicePixelRatio);
+
+    if (const QPixmap *pixmap = m_pixmapCache.object(key)) {
+        return *pixmap;
+    }
+
+    const QIcon dragIcon = iconName.isEmpty() ? icon : QIcon::fromTheme(iconName);
+    if (dragIcon.isNull()) {
+        return QPixmap();
+    }
+
+    const QPixmap pixmap = dragIcon.pixmap(window, QSize(m_dragIconSize, m_dragIconSize));
+    m_pixmapCache.insert(key, new QPixmap(pixmap));
+    return pixmap;
 }
 
-void DragHelper::doDrag(QQuickItem *item, QMimeData *mimeData, const QIcon &icon)
+void DragHelper::doDrag(QQuickItem *item, QMimeData *mimeData, const QIcon &icon, const QString &iconName)
 {
     QDrag *drag = new QDrag(item);
     drag->setMimeData(mimeData);
 
-    if (!icon.isNull()) {
-        drag->setPixmap(icon.pixmap(m_dragIconSize, m_dragIconSize));
+    const QPixmap pixmap = dragPixmap(item, icon, iconName);
+    if (!pixmap.isNull()) {
+        drag->setPixmap(pixmap);
     }
 
     drag->exec();
@@ -6,8 +6,10 @@
 #ifndef DRAGHELPER_H
 #define DRAGHELPER_H
 
+#include <QCache>
 #include <QIcon>
 #include <QObject>
+#include <QPixmap>
 
 #include "milou_export.h"
 
@@ -39,7 +41,11 @@ Q_SIGNALS:
 
 private:
     int m_dragIconSize;
-    Q_INVOKABLE void doDrag(QQuickItem *item, QMimeData *mimeData, const QIcon &icon = QIcon());
+    // Rendered drag icons, keyed by icon, size and device pixel ratio
+    QCache<QString, QPixmap> m_pixmapCache;
+
+    QPixmap dragPixmap(QQuickItem *item, const QIcon &icon, const QString &iconName);
+    Q_INVOKABLE void doDrag(QQuickItem *item, QMimeData *mimeData, const QIcon &icon, const QString &iconName);
 };
 
 }
@@ -0,0 +1,44 @@
+/*
+ * This file is part of the KDE Milou Project
+ * SPDX-FileCopyrightText: 2026 Milou Authors
+ *
+ * SPDX-License-Identifier: LGPL-2.1-only OR LGPL-3.0-only OR LicenseRef-KDE-Accepted-LGPL
+ *
+ */
+
+#include "frecencyprovider.h"
+
+#include <KRunner/RunnerManager>
+
+#include "frecencystore.h"
+
+using namespace Milou;
+
+// Single letters are covered by the recent launches
+static const int s_minQueryLength = 2;
+static const int s_maxMatches = 3;
+
+FrecencyProvider::FrecencyProvider(FrecencyStore *store, Plasma::RunnerManager *manager, QObject *parent)
+    : MatchProvider(parent)
+    , m_store(store)
+    , m_manager(manager)
+{
+}
+
+FrecencyProvider::~FrecencyProvider() = default;
+
+void FrecencyProvider::match(const QString &query, QVector<Plasma::QueryMatch> &matches)
+{
+    const QString trimmedQuery = query.trimmed();
+    if (trimmedQuery.size() < s_minQueryLength) {
+        return;
+    }
+
+    const auto storedMatches = m_store->recentMatches(trimmedQuery, s_maxMatches);
+    for (const StoredMatch &storedMatch : storedMatches) {
+        Plasma::QueryMatch match = storedMatch.toQueryMatch(m_manager);
+        if (match.isValid()) {
+            matches.append(match);
+        }
+    }
+}
@@ -0,0 +1,43 @@
+/*
+ * This file is part of the KDE Milou Project
+ * SPDX-FileCopyrightText: 2026 Milou Authors
+ *
+ * SPDX-License-Identifier: LGPL-2.1-only OR LGPL-3.0-only OR LicenseRef-KDE-Accepted-LGPL
+ *
+ */
+
+#pragma once
+
+#include "matchprovider.h"
+
+namespace Plasma
+{
+class RunnerManager;
+}
+
+namespace Milou
+{
+class FrecencyStore;
+
+/**
+ * Offers the launched matches whose text starts with the query
+ *
+ * Answers from the in-memory index of the FrecencyStore,
+ * the matches are run by their original runners.
+ */
+class FrecencyProvider : public MatchProvider
+{
+    Q_OBJECT
+
+public:
+    FrecencyProvider(FrecencyStore *store, Plasma::RunnerManager *manager, QObject *parent = nullptr);
+    ~FrecencyProvider() override;
+
+    void match(const QString &query, QVector<Plasma::QueryMatch> &matches) override;
+
+private:
+    FrecencyStore *m_store;
+    Plasma::RunnerManager *m_manager;
+};
+
+} // namespace Milou
@@ -0,0 +1,412 @@
+/*
+ * This file is part of the KDE Milou Project
+ * SPDX-FileCopyrightText: 2026 Milou Authors
+ *
+ * SPDX-License-Identifier: LGPL-2.1-only OR LGPL-3.0-only OR LicenseRef-KDE-Accepted-LGPL
+ *
+ */
+
+#include "frecencystore.h"
+
+#include <QDataStream>
+#include <QDateTime>
+#include <QDir>
+#include <QFileInfo>
+#include <QLockFile>
+#include <QSaveFile>
+#include <QStandardPaths>
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+
+#include "mappedfile.h"
+
+using namespace Milou;
+
+static const quint32 s_magic = 0x4d4c4652; // MLFR
+static const quint32 s_version = 3;
+
+// A launch is worth half as much after a week
+static const qreal s_halfLife = 7 * 24 * 60 * 60 * 1000.0;
+// Compact once there are this many superseded records
+static const int s_maxStaleRecords = 256;
+// The file grows in steps of this, so appending rarely needs a new mapping
+static const qint64 s_growthStep = 16 * 1024;
+
+FrecencyStore::FrecencyStore(const QString &fileName)
+    : m_file(fileName)
+{
+}
+
+FrecencyStore::~FrecencyStore()
+{
+    closeFile();
+}
+
+QString FrecencyStore::defaultFileName()
+{
+    return QStandardPaths::writableLocation(QStandardPaths::GenericDataLocation) + QLatin1String("/milou/frecency");
+}
+
+QString FrecencyStore::lockFileName() const
+{
+    return m_file.fileName() + QLatin1String(".lock");
+}
+
+bool FrecencyStore::open()
+{
+    // The file is only read when it's first needed
+    if (m_opened) {
+        return m_data;
+    }
+    m_opened = true;
+
+    QDir().mkpath(QFileInfo(m_file.fileName()).absolutePath());
+
+    QLockFile lock(lockFileName());
+    if (!lock.tryLock(MappedFile::s_lockTimeout)) {
+        // Try again next time
+        m_opened = false;
+        return false;
+    }
+    return openLocked();
+}
+
+bool FrecencyStore::openLocked()
+{
+    closeFile();
+
+    if (!m_file.open(QIODevice::ReadWrite)) {
+        return false;
+    }
+
+    FileHeader header{0, 0, 0, 0, 0};
+    if (m_file.size() >= qint64(sizeof(FileHeader))) {
+        m_file.read(reinterpret_cast<char *>(&header), sizeof(header));
+    }
+
+    if (header.magic != s_magic || header.version != s_version || header.superseded) {
+        // Empty, foreign or outdated, start over
+        const FileHeader newHeader{s_magic, s_version, 0, 0, sizeof(FileHeader)};
+        if (!MappedFile::replace(&m_file, QByteArray(reinterpret_cast<const char *>(&newHeader), sizeof(newHeader)))) {
+            return false;
+        }
+    }
+
+    if (!remap()) {
+        closeFile();
+        return false;
+    }
+
+    m_end = sizeof(FileHeader);
+    indexRecords();
+    return true;
+}
+
+void FrecencyStore::closeFile()
+{
+    if (m_data) {
+        m_file.unmap(m_data);
+        m_data = nullptr;
+    }
+    m_size = 0;
+    m_end = 0;
+    m_index.clear();
+    m_ranking.clear();
+    m_recordCount = 0;
+    m_file.close();
+}
+
+bool FrecencyStore::remap()
+{
+    if (m_data) {
+        m_file.unmap(m_data);
+        m_data = nullptr;
+    }
+    m_size = m_file.size();
+    if (m_size >= qint64(sizeof(FileHeader))) {
+        m_data = m_file.map(0, m_size);
+    }
+    if (!m_data) {
+        m_size = 0;
+    }
+    return m_data;
+}
+
+FrecencyStore::FileHeader FrecencyStore::fileHeader() const
+{
+    FileHeader header;
+    std::memcpy(&header, m_data, sizeof(FileHeader));
+    return header;
+}
+
+void FrecencyStore::setUsed(quint64 used)
+{
+    std::memcpy(m_data + offsetof(FileHeader, used), &used, sizeof(used));
+}
+
+void FrecencyStore::indexRecords()
+{
+    const qint64 used = qint64(fileHeader().used);
+
+    RecordHeader record;
+    while (m_end < used && readHeader(m_end, &record) && m_end + record.size <= used) {
+        indexRecord(readMatch(m_end).key(), m_end);
+        ++m_recordCount;
+        m_end += record.size;
+    }
+
+    // What is left of a record that was never completed or got cut off, the next one overwrites it
+    if (m_end != used) {
+        setUsed(m_end);
+    }
+}
+
+void FrecencyStore::indexRecord(const QString &key, qint64 offset)
+{
+    RecordHeader header;
+
+    const auto it = m_index.find(key);
+    if (it != m_index.end()) {
+        if (readHeader(*it, &header)) {
+            m_ranking.remove(rank(header), *it);
+        }
+        *it = offset;
+    } else {
+        m_index.insert(key, offset);
+    }
+
+    if (readHeader(offset, &header)) {
+        m_ranking.insert(rank(header), offset);
+    }
+}
+
+void FrecencyStore::refresh()
+{
+    if (!m_data) {
+        return;
+    }
+
+    const FileHeader header = fileHeader();
+    if (!header.superseded && qint64(header.used) == m_end) {
+        return;
+    }
+
+    QLockFile lock(lockFileName());
+    if (lock.tryLock(MappedFile::s_lockTimeout)) {
+        refreshLocked();
+    }
+}
+
+void FrecencyStore::refreshLocked()
+{
+    if (fileHeader().superseded) {
+        // Another process compacted the store into a new file
+        openLocked();
+        return;
+    }
+
+    if (qint64(fileHeader().used) > m_size) {
+        remap();
+    }
+    indexRecords();
+}
+
+bool FrecencyStore::readHeader(qint64 offset, RecordHeader *header) const
+{
+    if (!m_data || offset + qint64(sizeof(RecordHeader)) > m_size) {
+        return false;
+    }
+    std::memcpy(header, m_data + offset, sizeof(RecordHeader));
+    return header->size > sizeof(RecordHeader) && offset + header->size <= m_size;
+}
+
+StoredMatch FrecencyStore::readMatch(qint64 offset) const
+{
+    RecordHeader header;
+    StoredMatch match;
+    if (!readHeader(offset, &header)) {
+        return match;
+    }
+
+    const QByteArray payload = QByteArray::fromRawData(reinterpret_cast<const char *>(m_data + offset + sizeof(RecordHeader)), header.size - sizeof(RecordHeader));
+    QDataStream stream(payload);
+    stream.setVersion(QDataStream::Qt_5_15);
+    stream >> match;
+    return match;
+}
+
+QString FrecencyStore::readText(qint64 offset) const
+{
+    RecordHeader header;
+    if (!readHeader(offset, &header)) {
+        return QString();
+    }
+
+    const QByteArray payload = QByteArray::fromRawData(reinterpret_cast<const char *>(m_data + offset + sizeof(RecordHeader)), header.size - sizeof(RecordHeader));
+    QDataStream stream(payload);
+    stream.setVersion(QDataStream::Qt_5_15);
+    // Only decode as far as needed, the text follows the ids
+    QString runnerId;
+    QString id;
+    QString text;
+    stream >> runnerId >> id >> text;
+    return text;
+}
+
+QByteArray FrecencyStore::serialize(const RecordHeader &header, const StoredMatch &match) const
+{
+    QByteArray payload;
+    QDataStream stream(&payload, QIODevice::WriteOnly);
+    stream.setVersion(QDataStream::Qt_5_15);
+    stream << match;
+
+    RecordHeader completeHeader = header;
+    completeHeader.size = sizeof(RecordHeader) + payload.size();
+
+    QByteArray record(reinterpret_cast<const char *>(&completeHeader), sizeof(RecordHeader));
+    record.append(payload);
+    return record;
+}
+
+qreal FrecencyStore::decayedScore(const RecordHeader &header, qint64 now)
+{
+    return header.score * std::pow(0.5, qMax<qint64>(0, now - header.lastUsed) / s_halfLife);
+}
+
+qreal FrecencyStore::rank(const RecordHeader &header)
+{
+    // Decaying every score back to the same point in time keeps their order, logarithms keep them in range
+    return std::log2(qMax(header.score, 1e-9)) + header.lastUsed / s_halfLife;
+}
+
+void FrecencyStore::recordLaunch(const Plasma::QueryMatch &match)
+{
+    if (!StoredMatch::isStorable(match) || !open()) {
+        return;
+    }
+
+    QLockFile lock(lockFileName());
+    if (!lock.tryLock(MappedFile::s_lockTimeout)) {
+        return;
+    }
+
+    // Build on what the other processes recorded and append after it
+    refreshLocked();
+    if (!m_data) {
+        return;
+    }
+
+    const StoredMatch stored = StoredMatch::fromQueryMatch(match);
+    const QString key = stored.key();
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+
+    RecordHeader header{0, 1, now, 1.0};
+
+    const qint64 previousOffset = m_index.value(key, -1);
+    RecordHeader previous;
+    if (previousOffset >= 0 && readHeader(previousOffset, &previous)) {
+        header.count = previous.count + 1;
+        header.score = decayedScore(previous, now) + 1.0;
+    }
+
+    const QByteArray record = serialize(header, stored);
+    const qint64 offset = m_end;
+
+    if (offset + record.size() > m_size) {
+        // Growing is safe for those who have the file mapped, shrinking wouldn't be
+        const qint64 size = (offset + record.size() + s_growthStep - 1) / s_growthStep * s_growthStep;
+        if (!m_file.resize(size) || !remap()) {
+            return;
+        }
+    }
+
+    // The record only counts once it is complete
+    std::memcpy(m_data + offset, record.constData(), record.size());
+    setUsed(offset + record.size());
+
+    indexRecord(key, offset);
+    ++m_recordCount;
+    m_end = offset + record.size();
+
+    if (m_recordCount - m_index.count() > s_maxStaleRecords || m_index.count() > s_maxEntries) {
+        compact();
+    }
+}
+
+void FrecencyStore::compact()
+{
+    // Keep the highest scoring matches, with room for new ones so the next one doesn't compact again
+    const int keep = m_index.count() > s_maxEntries ? s_compactedEntries : s_maxEntries;
+    QByteArray records;
+    int kept = 0;
+    for (auto it = m_ranking.constEnd(); it != m_ranking.constBegin() && kept < keep; ++kept) {
+        --it;
+        RecordHeader header;
+        if (readHeader(it.value(), &header)) {
+            records.append(reinterpret_cast<const char *>(m_data + it.value()), header.size);
+        }
+    }
+
+    // Written to a new file, the others keep using the old one until they notice it was superseded
+    QSaveFile file(m_file.fileName());
+    if (!file.open(QIODevice::WriteOnly)) {
+        return;
+    }
+
+    const FileHeader header{s_magic, s_version, 0, 0, sizeof(FileHeader) + quint64(records.size())};
+    file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    file.write(records);
+    if (!file.commit()) {
+        return;
+    }
+
+    const quint32 superseded = 1;
+    std::memcpy(m_data + offsetof(FileHeader, superseded), &superseded, sizeof(superseded));
+
+    openLocked();
+}
+
+qreal FrecencyStore::score(const QString &key)
+{
+    if (!open()) {
+        return 0;
+    }
+    refresh();
+
+    const qint64 offset = m_index.value(key, -1);
+    RecordHeader header;
+    if (offset < 0 || !readHeader(offset, &header)) {
+        return 0;
+    }
+    return decayedScore(header, QDateTime::currentMSecsSinceEpoch());
+}
+
+int FrecencyStore::count()
+{
+    if (!open()) {
+        return 0;
+    }
+    refresh();
+
+    return m_index.count();
+}
+
+QVector<StoredMatch> FrecencyStore::recentMatches(const QString &query, int limit)
+{
+    if (!open()) {
+        return {};
+    }
+    refresh();
+
+    QVector<StoredMatch> matches;
+    for (auto it = m_ranking.constEnd(); it != m_ranking.constBegin() && matches.count() < limit;) {
+        --it;
+        if (query.isEmpty() || readText(it.value()).startsWith(query, Qt::CaseInsensitive)) {
+            matches.append(readMatch(it.value()));
+        }
+    }
+    return matches;
+}
@@ -0,0 +1,137 @@
+/*
+ * This file is part of the KDE Milou Project
+ * SPDX-FileCopyrightText: 2026 Milou Authors
+ *
+ * SPDX-License-Identifier: LGPL-2.1-only OR LGPL-3.0-only OR LicenseRef-KDE-Accepted-LGPL
+ *
+ */
+
+#pragma once
+
+#include <QFile>
+#include <QHash>
+#include <QMultiMap>
+#include <QVector>
+
+#include "storedmatch.h"
+
+namespace Milou
+{
+/**
+ * Remembers which matches the user launched, how often and how recently
+ *
+ * The store is a memory-mapped log of records that is only ever appended to.
+ * Each launch appends a new record for the match superseding the previous one,
+ * once there are too many superseded records the file is compacted.
+ * An in-memory index points at the latest record of every match so that
+ * looking up a score doesn't need to touch more than that record, and
+ * keeps them in the order of their scores for finding the highest ones.
+ *
+ * Every process using Milou, e.g. krunner and plasmashell, shares the file.
+ * Writers take a lock file, records only count once the header says they are
+ * complete, and a compacted file replaces the old one, which is marked as
+ * superseded, so the others notice what changed and catch up before they
+ * next use the store.
+ */
+class FrecencyStore
+{
+public:
+    /**
+     * The file is only opened once the store is first used
+     */
+    explicit FrecencyStore(const QString &fileName = defaultFileName());
+    ~FrecencyStore();
+
+    static QString defaultFileName();
+
+    /**
+     * Matches remembered at most, once there are more the lowest scoring ones are
+     * dropped until s_compactedEntries are left
+     */
+    static constexpr int s_maxEntries = 500;
+    static constexpr int s_compactedEntries = s_maxEntries * 4 / 5;
+
+    /**
+     * Records that @p match was launched, unless it can't be stored
+     *
+     * @sa StoredMatch::isStorable
+     */
+    void recordLaunch(const Plasma::QueryMatch &match);
+
+    /**
+     * The score of the match with the given @p key, decayed to now,
+     * 0 if it was never launched
+     *
+     * @sa StoredMatch::key
+     */
+    qreal score(const QString &key);
+
+    /**
+     * The highest scoring matches whose text starts with @p query,
+     * or any matches for an empty @p query
+     */
+    QVector<StoredMatch> recentMatches(const QString &query, int limit);
+
+    /**
+     * Number of matches in the store
+     */
+    int count();
+
+private:
+    struct FileHeader {
+        quint32 magic;
+        quint32 version;
+        quint32 superseded; // set once a compacted file replaced this one
+        quint32 reserved;
+        quint64 used; // size of the header and all complete records
+    };
+
+    struct RecordHeader {
+        quint32 size; // including this header
+        quint32 count;
+        qint64 lastUsed; // msecs since epoch
+        double score; // as of lastUsed
+    };
+
+    bool open();
+    // These expect the lock file to be held
+    bool openLocked();
+    void closeFile();
+    void refreshLocked();
+    void indexRecords();
+    void indexRecord(const QString &key, qint64 offset);
+    bool remap();
+    void compact();
+
+    // Catches up with what other processes changed
+    void refresh();
+
+    QString lockFileName() const;
+
+    FileHeader fileHeader() const;
+    void setUsed(quint64 used);
+
+    bool readHeader(qint64 offset, RecordHeader *header) const;
+    StoredMatch readMatch(qint64 offset) const;
+    QString readText(qint64 offset) const;
+    QByteArray serialize(const RecordHeader &header, const StoredMatch &match) const;
+
+    static qreal decayedScore(const RecordHeader &header, qint64 now);
+    // All scores decay at the same rate, so the order this gives doesn't change over time
+    static qreal rank(const RecordHeader &header);
+
+    QFile m_file;
+    bool m_opened = false;
+    uchar *m_data = nullptr;
+    // What is mapped, the file is grown in steps so it needs to be remapped rarely
+    qint64 m_size = 0;
+    // Where the records indexed so far end
+    qint64 m_end = 0;
+
+    QHash<QString /*key*/, qint64 /*offset*/> m_index;
+    // The latest records, lowest score first
+    QMultiMap<qreal /*rank*/, qint64 /*offset*/> m_ranking;
+    int m_recordCount = 0;
+};
+
+} // namespace Milou
@@ -0,0 +1,128 @@
+/*
+ * This file is part of the KDE Milou Project
+ * SPDX-FileCopyrightText: 2026 Milou Authors
+ *
+ * SPDX-License-Identifier: LGPL-2.1-only OR LGPL-3.0-only OR LicenseRef-KDE-Accepted-LGPL
+ *
+ */
+
+#include "heightsettler.h"
+
+#include <cmath>
+
+using namespace Milou;
+
+// About one frame
+static const int s_minResizeInterval = 16;
+
+HeightSettler::HeightSettler(QObject *parent)
+    : QObject(parent)
+{
+    m_settleTimer.setSingleShot(true);
+    connect(&m_settleTimer, &QTimer::timeout, this, &HeightSettler::settle);
+}
+
+HeightSettler::~HeightSettler() = default;
+
+qreal HeightSettler::targetHeight() const
+{
+    return m_targetHeight;
+}
+
+void HeightSettler::setTargetHeight(qreal height)
+{
+    if (m_targetHeight == height) {
+        return;
+    }
+
+    m_targetHeight = height;
+    Q_EMIT targetHeightChanged();
+    scheduleSettle();
+}
+
+qreal HeightSettler::settledHeight() const
+{
+    return m_settledHeight;
+}
+
+int HeightSettler::quantum() const
+{
+    return m_quantum;
+}
+
+void HeightSettler::setQuantum(int quantum)
+{
+    quantum = qMax(1, quantum);
+    if (m_quantum == quantum) {
+        return;
+    }
+
+    m_quantum = quantum;
+    Q_EMIT quantumChanged();
+    scheduleSettle();
+}
+
+bool HeightSettler::growOnly() const
+{
+    return m_growOnly;
+}
+
+void HeightSettler::setGrowOnly(bool growOnly)
+{
+    if (m_growOnly == growOnly) {
+        return;
+    }
+
+    m_growOnly = growOnly;
+    Q_EMIT growOnlyChanged();
+    // Shrink to what's needed now
+    if (!m_growOnly) {
+        scheduleSettle();
+    }
+}
+
+int HeightSettler::resizeCount() const
+{
+    return m_resizeCount;
+}
+
+void HeightSettler::reset()
+{
+    if (m_resizeCount != 0) {
+        m_resizeCount = 0;
+        Q_EMIT resizeCountChanged();
+    }
+}
+
+void HeightSettler::scheduleSettle()
+{
+    if (m_settleTimer.isActive()) {
+        return;
+    }
+
+    const qint64 sinceLastResize = m_lastResize.isValid() ? m_lastResize.elapsed() : s_minResizeInterval;
+    if (sinceLastResize >= s_minResizeInterval) {
+        settle();
+    } else {
+        m_settleTimer.start(int(s_minResizeInterval - sinceLastResize));
+    }
+}
+
+void HeightSettler::settle()
+{
+    qreal height = std::ceil(m_targetHeight / m_quantum) * m_quantum;
+    if (m_growOnly) {
+        height = qMax(height, m_settledHeight);
+    }
+
+    if (m_settledHeight == height) {
+        return;
+    }
+
+    m_settledHeight = height;
+    m_lastResize.start();
+    ++m_resizeCount;
+
+    Q_EMIT settledHeightChanged();
+    Q_EMIT resizeCountChanged();
+}
@@ -0,0 +1,99 @@
+/*
+ * This file is part of the KDE Milou Project
+ * SPDX-FileCopyrightText: 2026 Milou Authors
+ *
+ * SPDX-License-Identifier: LGPL-2.1-only OR LGPL-3.0-only OR LicenseRef-KDE-Accepted-LGPL
+ *
+ */
+
+#pragma once
+
+#include <QElapsedTimer>
+#include <QObject>
+#include <QTimer>
+
+#include "milou_export.h"
+
+namespace Milou
+{
+/**
+ * Turns a height that changes a lot into one that is cheap to follow
+ *
+ * Results trickling in change the height of the content with every row,
+ * resizing a popup window for each of them is expensive. The settled height
+ * is rounded up to a multiple of the quantum, changes at most once per frame
+ * and optionally only grows.
+ */
+class MILOU_EXPORT HeightSettler : public QObject
+{
+    Q_OBJECT
+
+    /**
+     * The height the content would like to have
+     */
+    Q_PROPERTY(qreal targetHeight READ targetHeight WRITE setTargetHeight NOTIFY targetHeightChanged)
+    /**
+     * The height to actually use
+     */
+    Q_PROPERTY(qreal settledHeight READ settledHeight NOTIFY settledHeightChanged)
+    /**
+     * The settled height is rounded up to a multiple of this
+     *
+     * Default is 1, i.e. no rounding other than to whole pixels
+     */
+    Q_PROPERTY(int quantum READ quantum WRITE setQuantum NOTIFY quantumChanged)
+    /**
+     * Whether the settled height may only grow, e.g. while a query is running
+     *
+     * Once this is disabled again the settled height follows the target height.
+     */
+    Q_PROPERTY(bool growOnly READ growOnly WRITE setGrowOnly NOTIFY growOnlyChanged)
+    /**
+     * How often the settled height changed since the last reset()
+     */
+    Q_PROPERTY(int resizeCount READ resizeCount NOTIFY resizeCountChanged)
+
+public:
+    explicit HeightSettler(QObject *parent = nullptr);
+    ~HeightSettler() override;
+
+    qreal targetHeight() const;
+    void setTargetHeight(qreal height);
+
+    qreal settledHeight() const;
+
+    int quantum() const;
+    void setQuantum(int quantum);
+
+    bool growOnly() const;
+    void setGrowOnly(bool growOnly);
+
+    int resizeCount() const;
+
+    /**
+     * Resets the resize count, e.g. when a new query starts
+     */
+    Q_INVOKABLE void reset();
+
+Q_SIGNALS:
+    void targetHeightChanged();
+    void settledHeightChanged();
+    void quantumChanged();
+    void growOnlyChanged();
+    void resizeCountChanged();
+
+private:
+    void scheduleSettle();
+    void settle();
+
+    qreal m_targetHeight = 0;
+    qreal m_settledHeight = 0;
+    int m_quantum = 1;
+    bool m_growOnly = false;
+    int m_resizeCount = 0;
+
+    QTimer m_settleTimer;
+    QElapsedTimer m_lastResize;
+};
+
+} // namespace Milou
@@ -0,0 +1,209 @@
+/*
+ * This file is part of the KDE Milou Project
+ * SPDX-FileCopyrightText: 2026 Milou Authors
+ *
+ * SPDX-License-Identifier: LGPL-2.1-only OR LGPL-3.0-only OR LicenseRef-KDE-Accepted-LGPL
+ *
+ */
+
+#include "latencyhistograms.h"
+
+#include <QDir>
+#include <QFileInfo>
+#include <QLockFile>
+#include <QStandardPaths>
+
+#include <cmath>
+#include <cstring>
+
+#include "mappedfile.h"
+
+using namespace Milou;
+
+static const quint32 s_magic = 0x4d4c4c48; // MLLH
+static const quint32 s_version = 1;
+// Buckets per power of two
+static const int s_bucketsPerOctave = 4;
+
+LatencyHistograms::LatencyHistograms(const QString &fileName)
+    : m_file(fileName)
+{
+}
+
+LatencyHistograms::~LatencyHistograms()
+{
+    if (m_data) {
+        m_file.unmap(m_data);
+    }
+}
+
+QString LatencyHistograms::defaultFileName()
+{
+    return QStandardPaths::writableLocation(QStandardPaths::GenericDataLocation) + QLatin1String("/milou/latency");
+}
+
+QString LatencyHistograms::metricName(Metric metric)
+{
+    switch (metric) {
+    case KeystrokeToFirstResult:
+        return QStringLiteral("keystroke-to-first-result");
+    case KeystrokeToStable:
+        return QStringLiteral("keystroke-to-stable");
+    case ActivationToLaunch:
+        return QStringLiteral("activation-to-launch");
+    case RunToLaunch:
+        return QStringLiteral("run-to-launch");
+    }
+    return QString();
+}
+
+bool LatencyHistograms::open()
+{
+    if (m_opened) {
+        return m_data;
+    }
+    m_opened = true;
+
+    QDir().mkpath(QFileInfo(m_file.fileName()).absolutePath());
+
+    // Only one process sets up the file
+    QLockFile lock(m_file.fileName() + QLatin1String(".lock"));
+    if (!lock.tryLock(MappedFile::s_lockTimeout)) {
+        // Try again next time
+        m_opened = false;
+        return false;
+    }
+
+    if (!m_file.open(QIODevice::ReadWrite)) {
+        return false;
+    }
+
+    // Start over with a file of another version, the buckets would mean something else
+    if (!hasCurrentHeader()) {
+        const Header expected{s_magic, s_version, s_metricCount, s_bucketCount};
+        QByteArray data(s_fileSize, 0);
+        std::memcpy(data.data(), &expected, sizeof(expected));
+        if (!MappedFile::replace(&m_file, data)) {
+            return false;
+        }
+    }
+
+    m_data = m_file.map(0, s_fileSize);
+    m_writable = true;
+    return m_data;
+}
+
+bool LatencyHistograms::openExisting(bool writable)
+{
+    if (m_opened) {
+        return m_data;
+    }
+    m_opened = true;
+
+    // No lock needed, the file is only ever replaced as a whole once it's set up
+    if (!m_file.open(writable ? QIODevice::ReadWrite : QIODevice::ReadOnly)) {
+        return false;
+    }
+    if (!hasCurrentHeader()) {
+        m_file.close();
+        return false;
+    }
+
+    m_data = m_file.map(0, s_fileSize);
+    m_writable = writable;
+    return m_data;
+}
+
+bool LatencyHistograms::hasCurrentHeader()
+{
+    const Header expected{s_magic, s_version, s_metricCount, s_bucketCount};
+
+    Header header{0, 0, 0, 0};
+    if (m_file.size() >= s_fileSize && m_file.seek(0)) {
+        m_file.read(reinterpret_cast<char *>(&header), sizeof(header));
+    }
+    return std::memcmp(&header, &expected, sizeof(Header)) == 0;
+}
+
+QBasicAtomicInteger<quint32> *LatencyHistograms::counter(Metric metric, int bucket) const
+{
+    // The mapping is page aligned, the header keeps the counters aligned
+    return reinterpret_cast<QBasicAtomicInteger<quint32> *>(m_data + sizeof(Header)) + metric * s_bucketCount + bucket;
+}
+
+int LatencyHistograms::bucket(qint64 msecs)
+{
+    // The first bucket takes everything below a millisecond
+    if (msecs < 1) {
+        return 0;
+    }
+    return qMin(s_bucketCount - 1, 1 + int(std::floor(std::log2(qreal(msecs)) * s_bucketsPerOctave)));
+}
+
+qreal LatencyHistograms::bucketUpperBound(int bucket)
+{
+    return std::exp2(qreal(bucket) / s_bucketsPerOctave);
+}
+
+void LatencyHistograms::record(Metric metric, qint64 msecs)
+{
+    if (msecs < 0 || !open() || !m_writable) {
+        return;
+    }
+    counter(metric, bucket(msecs))->fetchAndAddRelaxed(1);
+}
+
+QVector<quint32> LatencyHistograms::buckets(Metric metric) const
+{
+    QVector<quint32> buckets(s_bucketCount, 0);
+    if (m_data) {
+        for (int i = 0; i < s_bucketCount; ++i) {
+            buckets[i] = counter(metric, i)->loadRelaxed();
+        }
+    }
+    return buckets;
+}
+
+quint64 LatencyHistograms::count(Metric metric) const
+{
+    quint64 count = 0;
+    for (quint32 bucketCount : buckets(metric)) {
+        count += bucketCount;
+    }
+    return count;
+}
+
+qreal LatencyHistograms::percentile(Metric metric, qreal percentile) const
+{
+    const QVector<quint32> buckets = this->buckets(metric);
+
+    quint64 count = 0;
+    for (quint32 bucketCount : buckets) {
+        count += bucketCount;
+    }
+    if (count == 0) {
+        return -1;
+    }
+
+    const quint64 rank = quint64(std::ceil(count * qBound<qreal>(0, percentile, 100) / 100));
+    quint64 seen = 0;
+    for (int i = 0; i < buckets.count(); ++i) {
+        seen += buckets.at(i);
+        if (seen >= qMax<quint64>(1, rank)) {
+            return bucketUpperBound(i);
+        }
+    }
+    return bucketUpperBound(s_bucketCount - 1);
+}
+
+void LatencyHistograms::reset()
+{
+    if (!m_data || !m_writable) {
+        return;
+    }
+    for (int metric = 0; metric < s_metricCount; ++metric) {
+        for (int i = 0; i < s_bucketCount; ++i) {
+            counter(Metric(metric), i)->storeRelaxed(0);
+        }
+    }
+}
@@ -0,0 +1,102 @@
+/*
+ * This file is part of the KDE Milou Project
+ * SPDX-FileCopyrightText: 2026 Milou Authors
+ *
+ * SPDX-License-Identifier: LGPL-2.1-only OR LGPL-3.0-only OR LicenseRef-KDE-Accepted-LGPL
+ *
+ */
+
+#pragma once
+
+#include <QAtomicInteger>
+#include <QFile>
+#include <QVector>
+
+namespace Milou
+{
+/**
+ * Latency histograms that persist across sessions
+ *
+ * The histograms live in a small memory-mapped file that is shared by all
+ * processes using Milou. Only setting up the file takes a lock, recording
+ * a latency is a single atomic increment of its bucket, without locks or
+ * file I/O. The buckets grow logarithmically, four per power of two
+ * milliseconds, so percentiles are accurate to about 20% from a millisecond
+ * to 45 seconds. Anything slower lands in the last bucket.
+ *
+ * The milou-stats tool prints the percentiles.
+ */
+class LatencyHistograms
+{
+public:
+    enum Metric {
+        KeystrokeToFirstResult, ///< From typing to the first matches of the query showing up
+        KeystrokeToStable, ///< From typing to all runners having answered the query
+        ActivationToLaunch, ///< From activating the best match, e.g. pressing Enter while typing, until it was run
+        RunToLaunch, ///< From running a result directly, e.g. clicking it, until it was launched
+    };
+    static constexpr int s_metricCount = RunToLaunch + 1;
+    static constexpr int s_bucketCount = 64;
+
+    /**
+     * The file is only opened once the first latency is recorded
+     */
+    explicit LatencyHistograms(const QString &fileName = defaultFileName());
+    ~LatencyHistograms();
+
+    static QString defaultFileName();
+    static QString metricName(Metric metric);
+
+    /**
+     * Opens the file for recording, returns whether that worked
+     *
+     * The file is created if needed, one written by another version is started over.
+     */
+    bool open();
+    /**
+     * Opens the file as it is, without ever rewriting it, returns whether that worked
+     *
+     * Fails if there is no file or another version wrote it. Only reset() needs @p writable.
+     */
+    bool openExisting(bool writable = false);
+
+    void record(Metric metric, qint64 msecs);
+
+    QVector<quint32> buckets(Metric metric) const;
+    quint64 count(Metric metric) const;
+    /**
+     * The latency @p percentile percent of the recorded ones are below, the upper bound
+     * of the bucket it falls into, or -1 if nothing was recorded
+     */
+    qreal percentile(Metric metric, qreal percentile) const;
+
+    /**
+     * Forgets all recorded latencies, unless the file was opened read-only
+     */
+    void reset();
+
+    static int bucket(qint64 msecs);
+    /**
+     * The latencies in @p bucket are below this many milliseconds
+     */
+    static qreal bucketUpperBound(int bucket);
+
+private:
+    struct Header {
+        quint32 magic;
+        quint32 version;
+        quint32 metricCount;
+        quint32 bucketCount;
+    };
+    static constexpr qint64 s_fileSize = sizeof(Header) + s_metricCount * s_bucketCount * sizeof(quint32);
+
+    QBasicAtomicInteger<quint32> *counter(Metric metric, int bucket) const;
+    bool hasCurrentHeader();
+
+    QFile m_file;
+    bool m_opened = false;
+    bool m_writable = false;
+    uchar *m_data = nullptr;
+};
+
+} // namespace Milou
@@ -0,0 +1,74 @@
+/*
+ * This file is part of the KDE Milou Project
+ * SPDX-FileCopyrightText: 2026 Milou Authors
+ *
+ * SPDX-License-Identifier: LGPL-2.1-only OR LGPL-3.0-only OR LicenseRef-KDE-Accepted-LGPL
+ *
+ */
+
+#include "lazymimedata.h"
+
+#include <QUrl>
+
+#include <KRunner/RunnerManager>
+
+using namespace Milou;
+
+static const QString s_uriListFormat = QStringLiteral("text/uri-list");
+
+LazyMimeData::LazyMimeData(const Plasma::QueryMatch &match, Plasma::RunnerManager *manager)
+    : m_match(match)
+    , m_manager(manager)
+{
+}
+
+LazyMimeData::~LazyMimeData() = default;
+
+QMimeData *LazyMimeData::mimeData() const
+{
+    if (!m_mimeDataRetrieved) {
+        m_mimeDataRetrieved = true;
+        m_mimeData.reset(m_manager->mimeDataForMatch(m_match));
+    }
+    return m_mimeData.data();
+}
+
+bool LazyMimeData::hasFormat(const QString &mimeType) const
+{
+    return formats().contains(mimeType);
+}
+
+QStringList LazyMimeData::formats() const
+{
+    if (m_mimeDataRetrieved) {
+        return m_mimeData ? m_mimeData->formats() : QStringList();
+    }
+    // That's what runners provide by default
+    return {s_uriListFormat};
+}
+
+QVariant LazyMimeData::retrieveData(const QString &mimeType, QVariant::Type type) const
+{
+    Q_UNUSED(type);
+
+    QMimeData *data = mimeData();
+    if (!data) {
+        return QVariant();
+    }
+
+    // Let QMimeData take care of converting the urls into whatever is asked for
+    if (mimeType == s_uriListFormat && data->hasUrls()) {
+        QVariantList urls;
+        const auto dataUrls = data->urls();
+        urls.reserve(dataUrls.count());
+        for (const QUrl &url : dataUrls) {
+            urls.append(url);
+        }
+        return urls;
+    }
+
+    if (data->hasFormat(mimeType)) {
+        return data->data(mimeType);
+    }
+    return QVariant();
+}
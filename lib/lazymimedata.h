@@ -0,0 +1,53 @@
+/*
+ * This file is part of the KDE Milou Project
+ * SPDX-FileCopyrightText: 2026 Milou Authors
+ *
+ * SPDX-License-Identifier: LGPL-2.1-only OR LGPL-3.0-only OR LicenseRef-KDE-Accepted-LGPL
+ *
+ */
+
+#pragma once
+
+#include <QMimeData>
+#include <QScopedPointer>
+
+#include <KRunner/QueryMatch>
+
+namespace Plasma
+{
+class RunnerManager;
+}
+
+namespace Milou
+{
+/**
+ * Mime data of a match that is only asked of its runner once a drop target wants it
+ *
+ * The formats are predicted from the urls of the match so that a drag
+ * can start right away.
+ */
+class LazyMimeData : public QMimeData
+{
+    Q_OBJECT
+
+public:
+    LazyMimeData(const Plasma::QueryMatch &match, Plasma::RunnerManager *manager);
+    ~LazyMimeData() override;
+
+    bool hasFormat(const QString &mimeType) const override;
+    QStringList formats() const override;
+
+protected:
+    QVariant retrieveData(const QString &mimeType, QVariant::Type type) const override;
+
+private:
+    QMimeData *mimeData() const;
+
+    Plasma::QueryMatch m_match;
+    Plasma::RunnerManager *m_manager;
+
+    mutable bool m_mimeDataRetrieved = false;
+    mutable QScopedPointer<QMimeData> m_mimeData;
+};
+
+} // namespace Milou
@@ -0,0 +1,31 @@
+/*
+ * This file is part of the KDE Milou Project
+ * SPDX-FileCopyrightText: 2026 Milou Authors
+ *
+ * SPDX-License-Identifier: LGPL-2.1-only OR LGPL-3.0-only OR LicenseRef-KDE-Accepted-LGPL
+ *
+ */
+
+#include "mappedfile.h"
+
+#include <QFile>
+#include <QSaveFile>
+
+using namespace Milou;
+
+bool MappedFile::replace(QFile *file, const QByteArray &contents)
+{
+    QSaveFile newFile(file->fileName());
+    if (!newFile.open(QIODevice::WriteOnly)) {
+        file->close();
+        return false;
+    }
+    newFile.write(contents);
+    if (!newFile.commit()) {
+        file->close();
+        return false;
+    }
+
+    file->close();
+    return file->open(QIODevice::ReadWrite);
+}
@@ -0,0 +1,39 @@
+/*
+ * This file is part of the KDE Milou Project
+ * SPDX-FileCopyrightText: 2026 Milou Authors
+ *
+ * SPDX-License-Identifier: LGPL-2.1-only OR LGPL-3.0-only OR LicenseRef-KDE-Accepted-LGPL
+ *
+ */
+
+#pragma once
+
+#include <QByteArray>
+
+class QFile;
+
+namespace Milou
+{
+/**
+ * What the files that processes share through memory mappings have in common
+ */
+class MappedFile
+{
+public:
+    /**
+     * How long to wait for the lock of a file before giving up, in milliseconds
+     *
+     * The files are set up on the GUI thread and none of them is essential.
+     */
+    static constexpr int s_lockTimeout = 100;
+
+    /**
+     * Replaces @p file, which is open, by one holding @p contents and opens that read-write
+     *
+     * Processes that have the old file mapped keep using it, where shrinking it
+     * in place would crash them. Returns whether that worked, @p file is closed otherwise.
+     */
+    static bool replace(QFile *file, const QByteArray &contents);
+};
+
+} // namespace Milou
@@ -0,0 +1,24 @@
+/*
+ * This file is part of the KDE Milou Project
+ * SPDX-FileCopyrightText: 2026 Milou Authors
+ *
+ * SPDX-License-Identifier: LGPL-2.1-only OR LGPL-3.0-only OR LicenseRef-KDE-Accepted-LGPL
+ *
+ */
+
+#include "matchprovider.h"
+
+using namespace Milou;
+
+MatchProvider::MatchProvider(QObject *parent)
+    : QObject(parent)
+{
+}
+
+MatchProvider::~MatchProvider() = default;
+
+bool MatchProvider::run(const Plasma::QueryMatch &match)
+{
+    Q_UNUSED(match);
+    return false;
+}
@@ -0,0 +1,63 @@
+/*
+ * This file is part of the KDE Milou Project
+ * SPDX-FileCopyrightText: 2026 Milou Authors
+ *
+ * SPDX-License-Identifier: LGPL-2.1-only OR LGPL-3.0-only OR LicenseRef-KDE-Accepted-LGPL
+ *
+ */
+
+#pragma once
+
+#include <QObject>
+#include <QVector>
+
+#include <KRunner/QueryMatch>
+
+#include "milou_export.h"
+
+namespace Milou
+{
+/**
+ * A source of matches that lives in the process of the model
+ *
+ * Unlike runners, providers are queried synchronously on the thread of the model
+ * whenever the query string changes, their matches show up without waiting for
+ * the RunnerManager. This makes them suitable for sources that can answer from
+ * memory in a fraction of a millisecond, anything slower belongs in a runner.
+ *
+ * Should a runner come up with a match of the same id, the one of the runner is shown.
+ */
+class MILOU_EXPORT MatchProvider : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit MatchProvider(QObject *parent = nullptr);
+    ~MatchProvider() override;
+
+    /**
+     * Appends the matches for @p query to @p matches
+     *
+     * The matches are added straight to the storage of the model,
+     * so they must not be kept around by the provider.
+     * Matches without a runner are handed back to run() when launched.
+     */
+    virtual void match(const QString &query, QVector<Plasma::QueryMatch> &matches) = 0;
+
+    /**
+     * Runs a @p match of this provider that doesn't have a runner
+     *
+     * Matches that do have one are run by it. The default implementation does nothing.
+     *
+     * @return whether the match was run
+     */
+    virtual bool run(const Plasma::QueryMatch &match);
+
+Q_SIGNALS:
+    /**
+     * Emitted when the matches of the provider for the current query changed
+     */
+    void matchesChanged();
+};
+
+} // namespace Milou
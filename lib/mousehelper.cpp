@@ -8,6 +8,9 @@
 #include "mousehelper.h"
 
 #include <QCursor>
+#include <QEnterEvent>
+#include <QMouseEvent>
+#include <QWindow>
 
 using namespace Milou;
 
@@ -24,3 +27,81 @@ QPointF MouseHelper::globalMousePosition() const
 {
     return QCursor::pos();
 }
+
+QPointF MouseHelper::globalPosition() const
+{
+    return m_globalPosition;
+}
+
+bool MouseHelper::movedSinceReset() const
+{
+    return m_movedSinceReset;
+}
+
+void MouseHelper::resetMoved()
+{
+    // Asking the windowing system is a round trip, while the mouse is outside
+    // of the watched windows the position it comes back at is taken instead
+    m_resetPosition = m_globalPosition;
+    if (m_movedSinceReset) {
+        m_movedSinceReset = false;
+        Q_EMIT movedSinceResetChanged();
+    }
+}
+
+void MouseHelper::watchWindow(QWindow *window)
+{
+    if (!window || m_windows.contains(window)) {
+        return;
+    }
+
+    m_windows.removeAll(nullptr);
+    m_windows.append(window);
+    window->installEventFilter(this);
+}
+
+bool MouseHelper::eventFilter(QObject *watched, QEvent *event)
+{
+    switch (event->type()) {
+    case QEvent::MouseMove:
+    case QEvent::MouseButtonPress:
+    case QEvent::MouseButtonRelease:
+        setGlobalPosition(static_cast<QMouseEvent *>(event)->screenPos());
+        break;
+    case QEvent::Enter:
+        // Not every Enter event carries a position
+        if (auto *enterEvent = dynamic_cast<QEnterEvent *>(event)) {
+            setGlobalPosition(enterEvent->screenPos());
+        }
+        break;
+    case QEvent::Leave:
+        m_positionKnown = false;
+        break;
+    default:
+        break;
+    }
+
+    return QObject::eventFilter(watched, event);
+}
+
+void MouseHelper::setGlobalPosition(const QPointF &position)
+{
+    if (!m_positionKnown) {
+        m_positionKnown = true;
+        if (!m_movedSinceReset) {
+            m_resetPosition = position;
+        }
+    }
+
+    if (m_globalPosition == position) {
+        return;
+    }
+
+    m_globalPosition = position;
+    Q_EMIT globalPositionChanged();
+
+    if (!m_movedSinceReset && m_globalPosition != m_resetPosition) {
+        m_movedSinceReset = true;
+        Q_EMIT movedSinceResetChanged();
+    }
+}
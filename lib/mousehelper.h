@@ -10,6 +10,10 @@
 
 #include <QObject>
 #include <QPoint>
+#include <QPointer>
+#include <QVector>
+
+class QWindow;
 
 #include "milou_export.h"
 
@@ -19,11 +23,61 @@ class MILOU_EXPORT MouseHelper : public QObject
 {
     Q_OBJECT
 
+    /**
+     * The last known global position of the mouse
+     *
+     * This is updated from the mouse events the watched windows receive
+     * rather than by asking the windowing system, see watchWindow().
+     */
+    Q_PROPERTY(QPointF globalPosition READ globalPosition NOTIFY globalPositionChanged)
+    /**
+     * Whether the mouse moved since resetMoved() was last called
+     */
+    Q_PROPERTY(bool movedSinceReset READ movedSinceReset NOTIFY movedSinceResetChanged)
+
 public:
     explicit MouseHelper(QObject *parent = nullptr);
     ~MouseHelper() override;
 
+    /**
+     * Asks the windowing system for the position of the mouse, prefer globalPosition
+     */
     Q_INVOKABLE QPointF globalMousePosition() const;
+
+    QPointF globalPosition() const;
+    bool movedSinceReset() const;
+
+    /**
+     * Remembers the last known position, movedSinceReset is true again once the mouse leaves it
+     *
+     * While the mouse is outside of the watched windows its position is unknown,
+     * the position it comes back at is remembered instead.
+     */
+    Q_INVOKABLE void resetMoved();
+
+    /**
+     * Tracks the mouse events of @p window, usually the one showing the results
+     *
+     * The windows are watched until they are destroyed.
+     */
+    Q_INVOKABLE void watchWindow(QWindow *window);
+
+Q_SIGNALS:
+    void globalPositionChanged();
+    void movedSinceResetChanged();
+
+protected:
+    bool eventFilter(QObject *watched, QEvent *event) override;
+
+private:
+    void setGlobalPosition(const QPointF &position);
+
+    QVector<QPointer<QWindow>> m_windows;
+    QPointF m_globalPosition;
+    QPointF m_resetPosition;
+    // False until the first mouse event and after the mouse left a watched window
+    bool m_positionKnown = false;
+    bool m_movedSinceReset = false;
 };
 
 }
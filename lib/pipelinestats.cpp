@@ -0,0 +1,142 @@
+/*
+ * This file is part of the KDE Milou Project
+ * SPDX-FileCopyrightText: 2026 Milou Authors
+ *
+ * SPDX-License-Identifier: LGPL-2.1-only OR LGPL-3.0-only OR LicenseRef-KDE-Accepted-LGPL
+ *
+ */
+
+#include "pipelinestats.h"
+
+#include "roledatacache.h"
+#include "stallwatchdog.h"
+
+#include <QAbstractItemModel>
+#include <QPointer>
+#include <QTimer>
+
+using namespace Milou;
+
+class Q_DECL_HIDDEN PipelineStats::Private
+{
+public:
+    QVector<Stage> stages;
+    QVector<QPointer<QAbstractItemModel>> models;
+
+    RoleDataCache *dataCache = nullptr;
+    // Cache statistics when last reset, the cache counts for its whole lifetime
+    quint64 dataCacheHitsBase = 0;
+    quint64 dataCacheMissesBase = 0;
+
+    QTimer notifyTimer;
+};
+
+PipelineStats::PipelineStats(QObject *parent)
+    : QObject(parent)
+    , d(new Private)
+{
+    d->notifyTimer.setSingleShot(true);
+    d->notifyTimer.setInterval(100);
+    connect(&d->notifyTimer, &QTimer::timeout, this, &PipelineStats::statsChanged);
+}
+
+PipelineStats::~PipelineStats() = default;
+
+QVector<PipelineStats::Stage> PipelineStats::stages() const
+{
+    QVector<Stage> stages = d->stages;
+    for (int i = 0; i < stages.count(); ++i) {
+        if (const QAbstractItemModel *model = d->models.at(i)) {
+            stages[i].rows = StallWatchdog::rowCount(model);
+        }
+    }
+    return stages;
+}
+
+QVariantList PipelineStats::stageList() const
+{
+    QVariantList list;
+    const auto stages = this->stages();
+    list.reserve(stages.count());
+    for (const Stage &stage : stages) {
+        list.append(QVariantMap{
+            {QStringLiteral("name"), stage.name},
+            {QStringLiteral("rows"), stage.rows},
+            {QStringLiteral("invalidations"), stage.invalidations},
+            {QStringLiteral("resorts"), stage.resorts},
+            {QStringLiteral("totalTime"), stage.totalTime / 1000000.0},
+            {QStringLiteral("maxTime"), stage.maxTime / 1000000.0},
+        });
+    }
+    return list;
+}
+
+qint64 PipelineStats::dataCacheHits() const
+{
+    return d->dataCache ? qint64(d->dataCache->hits() - d->dataCacheHitsBase) : 0;
+}
+
+qint64 PipelineStats::dataCacheMisses() const
+{
+    return d->dataCache ? qint64(d->dataCache->misses() - d->dataCacheMissesBase) : 0;
+}
+
+qreal PipelineStats::dataCacheHitRate() const
+{
+    const qint64 lookups = dataCacheHits() + dataCacheMisses();
+    return lookups > 0 ? qreal(dataCacheHits()) / lookups : 0;
+}
+
+void PipelineStats::reset()
+{
+    for (Stage &stage : d->stages) {
+        stage = Stage{stage.name};
+    }
+
+    if (d->dataCache) {
+        d->dataCacheHitsBase = d->dataCache->hits();
+        d->dataCacheMissesBase = d->dataCache->misses();
+    }
+
+    d->notifyTimer.stop();
+    Q_EMIT statsChanged();
+}
+
+int PipelineStats::addStage(const QString &name, QAbstractItemModel *model)
+{
+    d->stages.append(Stage{name});
+    d->models.append(model);
+    return d->stages.count() - 1;
+}
+
+void PipelineStats::addChange(int stage, bool layoutChange)
+{
+    Stage &s = d->stages[stage];
+    if (layoutChange) {
+        ++s.resorts;
+    } else {
+        ++s.invalidations;
+    }
+
+    if (!d->notifyTimer.isActive()) {
+        d->notifyTimer.start();
+    }
+}
+
+void PipelineStats::addTime(int stage, qint64 nsecs)
+{
+    Stage &s = d->stages[stage];
+    s.totalTime += nsecs;
+    s.maxTime = qMax(s.maxTime, nsecs);
+
+    if (!d->notifyTimer.isActive()) {
+        d->notifyTimer.start();
+    }
+}
+
+void PipelineStats::setDataCache(RoleDataCache *cache)
+{
+    d->dataCache = cache;
+    d->dataCacheHitsBase = cache ? cache->hits() : 0;
+    d->dataCacheMissesBase = cache ? cache->misses() : 0;
+}
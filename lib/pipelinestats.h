@@ -0,0 +1,104 @@
+/*
+ * This file is part of the KDE Milou Project
+ * SPDX-FileCopyrightText: 2026 Milou Authors
+ *
+ * SPDX-License-Identifier: LGPL-2.1-only OR LGPL-3.0-only OR LicenseRef-KDE-Accepted-LGPL
+ *
+ */
+
+#pragma once
+
+#include <QObject>
+#include <QScopedPointer>
+#include <QVariantList>
+#include <QVector>
+
+#include "milou_export.h"
+
+class QAbstractItemModel;
+
+namespace Milou
+{
+class RoleDataCache;
+
+/**
+ * How much work each stage of the ResultsModel pipeline did
+ *
+ * The stages are the models the results flow through, from the RunnerResultsModel
+ * holding the matches through sorting, distributing, flattening, hiding the categories,
+ * detecting duplicates and finding the category boundaries to the ResultsModel.
+ *
+ * The time of a stage is what it spent handling the changes of the model before it,
+ * which is where a proxy filters and sorts, or what the RunnerResultsModel spent
+ * announcing its own changes. The stages further down and the views reacting to
+ * the changes a stage announced aren't counted for it, see StageProbe.
+ *
+ * The statistics are reset whenever a new query is launched.
+ */
+class MILOU_EXPORT PipelineStats : public QObject
+{
+    Q_OBJECT
+
+    /**
+     * A map per stage, in the order the results flow through them, with its
+     * name, rows, invalidations, resorts, totalTime and maxTime in milliseconds
+     */
+    Q_PROPERTY(QVariantList stages READ stageList NOTIFY statsChanged)
+    /**
+     * Number of ResultsModel::data() calls answered from its cache
+     */
+    Q_PROPERTY(qint64 dataCacheHits READ dataCacheHits NOTIFY statsChanged)
+    Q_PROPERTY(qint64 dataCacheMisses READ dataCacheMisses NOTIFY statsChanged)
+    Q_PROPERTY(qreal dataCacheHitRate READ dataCacheHitRate NOTIFY statsChanged)
+
+public:
+    explicit PipelineStats(QObject *parent = nullptr);
+    ~PipelineStats() override;
+
+    struct Stage {
+        QString name;
+        int rows = 0; ///< Including the rows of the categories for the models that still have them
+        int invalidations = 0; ///< Rows inserted, removed, moved, changed or reset
+        int resorts = 0; ///< Layout changes
+        qint64 totalTime = 0; ///< Nanoseconds
+        qint64 maxTime = 0; ///< Nanoseconds, of the slowest change
+    };
+
+    QVector<Stage> stages() const;
+    QVariantList stageList() const;
+
+    qint64 dataCacheHits() const;
+    qint64 dataCacheMisses() const;
+    qreal dataCacheHitRate() const;
+
+    /**
+     * Starts counting from zero
+     */
+    Q_INVOKABLE void reset();
+
+    /**
+     * Adds a stage whose changes are counted, returns its number
+     */
+    int addStage(const QString &name, QAbstractItemModel *model);
+    /**
+     * Counts a change @p stage announced
+     */
+    void addChange(int stage, bool layoutChange);
+    /**
+     * Adds @p nsecs @p stage spent on one change
+     */
+    void addTime(int stage, qint64 nsecs);
+    void setDataCache(RoleDataCache *cache);
+
+Q_SIGNALS:
+    /**
+     * Emitted at most every 100ms while the statistics change
+     */
+    void statsChanged();
+
+private:
+    class Private;
+    QScopedPointer<Private> d;
+};
+
+} // namespace Milou
@@ -7,128 +7,19 @@
  *
  */
 
-import QtQuick 2.1
+import QtQuick 2.15
 import QtQuick.Layouts 1.1
+import QtQuick.Window 2.2
 
 import org.kde.plasma.core 2.0 as PlasmaCore
 import org.kde.plasma.components 2.0 as PlasmaComponents
 
-MouseArea {
+ResultDelegateBase {
     id: resultDelegate
 
-    property variant theModel: model
-    property bool reversed: false
-
-    readonly property bool isCurrent: ListView.isCurrentItem // cannot properly Connect {} to this
-    readonly property bool sectionHasChanged: (reversed && ListView.section != ListView.nextSection)
-                                           || (!reversed && ListView.section != ListView.previousSection)
-
-    property int activeAction: -1
-
-    property string typeText: sectionHasChanged ? ListView.section : ""
-    property var additionalActions: typeof actions !== "undefined" ? actions : []
-    property int categoryWidth: units.gridUnit * 10
-
-    Accessible.role: Accessible.ListItem
-    Accessible.name: displayLabel.text
-    Accessible.description: {
-        var section = ListView.section;
-        if (!section) {
-            return "";
-        }
-        var subtext = subtextLabel.text;
-        if (subtext.length > 0) {
-            return i18nd("milou", "%1, in category %2", subtext, section);
-        } else {
-            return i18nd("milou", "in category %1", section);
-        }
-    }
-
-    property bool __pressed: false
-    property int __pressX: -1
-    property int __pressY: -1
-
-    onIsCurrentChanged: {
-        if (!isCurrent) {
-            activeAction = -1
-        }
-    }
-
-    function activateNextAction() {
-        if (activeAction === actionsRepeater.count - 1) { // last action, do nothing
-            return false
-        }
-        ++activeAction
-        return true
-    }
-
-    function activatePreviousAction() {
-        if (activeAction < 0) { // no action, do nothing
-            return false
-        }
-        --activeAction
-        return true
-    }
-
-    function activateLastAction() {
-        activeAction = actionsRepeater.count - 1
-    }
-
     width: listItem.implicitWidth
     height: listItem.implicitHeight
-
-    acceptedButtons: Qt.LeftButton
-    hoverEnabled: true
-    onPressed: {
-        __pressed = true;
-        __pressX = mouse.x;
-        __pressY = mouse.y;
-    }
-
-    onReleased: {
-        if (__pressed) {
-            listView.currentIndex = model.index
-            listView.runCurrentIndex()
-        }
-
-        __pressed = false;
-        __pressX = -1;
-        __pressY = -1;
-    }
-
-    onPositionChanged: {
-        if (__pressX != -1 && typeof dragHelper !== "undefined" && dragHelper.isDrag(__pressX, __pressY, mouse.x, mouse.y)) {
-            var resultsModel = ListView.view.model;
-            var mimeData = resultsModel.getMimeData(resultsModel.index(index, 0));
-            if (mimeData) {
-                dragHelper.startDrag(resultDelegate, mimeData, model.decoration);
-                __pressed = false;
-                __pressX = -1;
-                __pressY = -1;
-            }
-        }
-
-        if (!listView.moved && listView.mouseMovedGlobally()) {
-            listView.moved = true
-            listView.currentIndex = index
-        }
-    }
-
-    onContainsMouseChanged: {
-        if (!containsMouse) {
-            __pressed = false;
-            __pressX = -1;
-            __pressY = -1;
-        } else {
-            // In case we display the history we have a QML ListView which does not have the moved property
-            if (!listView.hasOwnProperty("moved") || listView.moved) {
-                listView.currentIndex = index
-            } else if (listView.mouseMovedGlobally()) {
-                listView.moved = true
-                listView.currentIndex = index
-            }
-        }
-    }
+    actionButtonHeight: listItem.height
 
     PlasmaComponents.Label {
         id: typeText
@@ -170,42 +61,62 @@ MouseArea {
             RowLayout {
                 anchors {
                     left: parent.left
-                    right: actionsRow.left
+                    right: actionsLoader.left
                     rightMargin: units.smallSpacing
                     verticalCenter: parent.verticalCenter
                 }
 
-                PlasmaCore.IconItem {
+                Loader {
                     id: typePixmap
                     Layout.preferredWidth: units.iconSizes.smallMedium
                     Layout.preferredHeight: units.iconSizes.smallMedium
                     Layout.fillHeight: true
-                    source: model.decoration
-                    usesPlasmaTheme: false
-                    animated: false
+                    // Icon names are rendered asynchronously and cached, only QIcons need an IconItem
+                    sourceComponent: typeof resultDelegate.rowIcon === "string" ? themeIconComponent : iconItemComponent
+                }
+
+                Component {
+                    id: themeIconComponent
+
+                    Image {
+                        source: resultDelegate.rowIcon ? "image://milouicon/" + resultDelegate.rowIcon + "?dpr=" + Screen.devicePixelRatio : ""
+                        sourceSize.width: units.iconSizes.smallMedium
+                        sourceSize.height: units.iconSizes.smallMedium
+                        fillMode: Image.PreserveAspectFit
+                        asynchronous: true
+                        smooth: true
+                    }
+                }
+
+                Component {
+                    id: iconItemComponent
+
+                    PlasmaCore.IconItem {
+                        source: resultDelegate.rowIcon
+                        usesPlasmaTheme: false
+                        animated: false
+                    }
                 }
 
                 PlasmaComponents.Label {
                     id: displayLabel
-                    text: String(typeof modelData !== "undefined" ? modelData : model.display)
+                    text: resultDelegate.rowText
 
                     height: undefined
 
                     elide: Text.ElideMiddle
-                    wrapMode: model.multiLine ? Text.WordWrap : Text.NoWrap
-                    maximumLineCount: model.multiLine ? Infinity : 1
+                    wrapMode: resultDelegate.rowMultiLine ? Text.WordWrap : Text.NoWrap
+                    maximumLineCount: resultDelegate.rowMultiLine ? Infinity : 1
                     verticalAlignment: Text.AlignVCenter
                     textFormat: Text.PlainText
 
-                    Layout.maximumWidth: labelWrapper.width - typePixmap.width - actionsRow.width
+                    Layout.maximumWidth: labelWrapper.width - typePixmap.width - actionsLoader.width
                 }
 
                 PlasmaComponents.Label {
                     id: subtextLabel
 
-                    // SourcesModel returns number of duplicates in this property
-                    // ResultsModel just has it as a boolean as you would expect from the name of the property
-                    text: model.isDuplicate === true || model.isDuplicate > 1 || resultDelegate.isCurrent ? String(model.subtext || "") : ""
+                    text: resultDelegate.rowSubtext
 
                     // HACK If displayLabel is too long it will shift this label outside boundaries
                     // but still render the text leading to it overlapping the action buttons looking horrible
@@ -222,55 +133,26 @@ MouseArea {
                     textFormat: Text.PlainText
 
                     Layout.fillWidth: true
-                    PlasmaCore.ToolTipArea {
+                    Loader {
                         anchors.fill: parent
-                        subText: subtextLabel.text
-                        active: containsMouse && subtextLabel.truncated
-                        timeout: -1
+                        active: resultDelegate.containsMouse && subtextLabel.truncated
+
+                        sourceComponent: PlasmaCore.ToolTipArea {
+                            subText: subtextLabel.text
+                            active: containsMouse
+                            timeout: -1
+                        }
                     }
                 }
             }
 
-            Row {
-                id: actionsRow
+            Loader {
+                id: actionsLoader
                 anchors.right: parent.right
                 anchors.verticalCenter: parent.verticalCenter
-                visible: resultDelegate.isCurrent
-
-                Repeater {
-                    id: actionsRepeater
-                    model: resultDelegate.additionalActions
+                active: resultDelegate.additionalActions.length > 0
 
-                    PlasmaComponents.ToolButton {
-                        width: height
-                        height: listItem.height
-                        visible: modelData.visible || true
-                        enabled: modelData.enabled || true
-                        tooltip: {
-                            var text = modelData.text || ""
-                            if (index === 0) { // Shift+Return will invoke first action
-                                text = i18ndc("milou", "placeholder is action e.g. run in terminal, in parenthesis is shortcut", "%1 (Shift+Return)", text)
-                            }
-                            return text
-                        }
-                        Accessible.role: Accessible.Button
-                        Accessible.name: modelData.text
-                        checkable: checked
-                        checked: resultDelegate.activeAction === index
-                        focus: resultDelegate.activeAction === index
-
-                        PlasmaCore.IconItem {
-                            anchors.centerIn: parent
-                            width: units.iconSizes.smallMedium
-                            height: units.iconSizes.smallMedium
-                            // ToolButton cannot cope with QIcon
-                            source: modelData.icon || ""
-                            active: parent.hovered || parent.checked
-                        }
-
-                        onClicked: resultDelegate.ListView.view.runAction(index)
-                    }
-                }
+                sourceComponent: resultDelegate.actionsComponent
             }
         }
     }
@@ -0,0 +1,208 @@
+/*
+ * This file is part of the KDE Milou Project
+ * SPDX-FileCopyrightText: 2013-2014 Vishesh Handa <me@vhanda.in>
+ * SPDX-FileCopyrightText: 2015-2016 Kai Uwe Broulik <kde@privat.broulik.de>
+ *
+ * SPDX-License-Identifier: LGPL-2.1-only OR LGPL-3.0-only OR LicenseRef-KDE-Accepted-LGPL
+ *
+ */
+
+import QtQuick 2.15
+
+import org.kde.plasma.core 2.0 as PlasmaCore
+import org.kde.plasma.components 2.0 as PlasmaComponents
+
+// What ResultDelegate and ResultRowDelegate have in common: what is shown,
+// input handling, keyboard navigation of the actions and the action buttons
+MouseArea {
+    id: resultDelegate
+
+    property variant theModel: model
+    property bool reversed: false
+
+    readonly property bool isCurrent: ListView.isCurrentItem // cannot properly Connect {} to this
+    // ResultsModel hands out everything shown in one snapshot, other models are asked role by role
+    readonly property var snapshot: typeof model.row !== "undefined" ? model.row : null
+    readonly property string rowText: snapshot ? snapshot.text : String(typeof modelData !== "undefined" ? modelData : model.display)
+    readonly property var rowIcon: snapshot ? snapshot.icon : model.decoration
+    // SourcesModel returns number of duplicates in this property
+    // ResultsModel just has it as a boolean as you would expect from the name of the property
+    readonly property string rowSubtext: snapshot ? (snapshot.isDuplicate || isCurrent ? snapshot.subtext : "")
+                                         : (model.isDuplicate === true || model.isDuplicate > 1 || isCurrent ? String(model.subtext || "") : "")
+    readonly property bool rowMultiLine: snapshot ? snapshot.multiLine : model.multiLine === true
+    readonly property string rowMatchKey: snapshot ? snapshot.matchKey : String(model.matchKey || "")
+
+    // ResultsModel knows where categories start and end, other models need the sections compared
+    readonly property bool sectionHasChanged: snapshot ? (reversed ? snapshot.isLastInCategory : snapshot.isFirstInCategory)
+                                              : (reversed && ListView.section != ListView.nextSection)
+                                                || (!reversed && ListView.section != ListView.previousSection)
+
+    property int activeAction: -1
+
+    property string typeText: sectionHasChanged ? ListView.section : ""
+    // Only the current row shows its actions, don't ask the runners for the others
+    property var additionalActions: isCurrent && typeof actions !== "undefined" ? actions : []
+    property int categoryWidth: units.gridUnit * 10
+    property real actionButtonHeight: height
+
+    // The buttons for the actions of the current row, for a Loader placed by the delegate
+    readonly property Component actionsComponent: Row {
+        Repeater {
+            model: resultDelegate.additionalActions
+
+            PlasmaComponents.ToolButton {
+                width: height
+                height: resultDelegate.actionButtonHeight
+                visible: modelData.visible || true
+                enabled: modelData.enabled || true
+                tooltip: {
+                    var text = modelData.text || ""
+                    if (index === 0) { // Shift+Return will invoke first action
+                        text = i18ndc("milou", "placeholder is action e.g. run in terminal, in parenthesis is shortcut", "%1 (Shift+Return)", text)
+                    }
+                    return text
+                }
+                Accessible.role: Accessible.Button
+                Accessible.name: modelData.text
+                checkable: checked
+                checked: resultDelegate.activeAction === index
+                focus: resultDelegate.activeAction === index
+
+                PlasmaCore.IconItem {
+                    anchors.centerIn: parent
+                    width: units.iconSizes.smallMedium
+                    height: units.iconSizes.smallMedium
+                    // ToolButton cannot cope with QIcon
+                    source: modelData.icon || ""
+                    active: parent.hovered || parent.checked
+                }
+
+                onClicked: resultDelegate.ListView.view.runAction(index)
+            }
+        }
+    }
+
+    Accessible.role: Accessible.ListItem
+    Accessible.name: rowText
+    Accessible.description: {
+        var section = ListView.section;
+        if (!section) {
+            return "";
+        }
+        var subtext = rowSubtext;
+        if (subtext.length > 0) {
+            return i18nd("milou", "%1, in category %2", subtext, section);
+        } else {
+            return i18nd("milou", "in category %1", section);
+        }
+    }
+
+    property bool __pressed: false
+    property int __pressX: -1
+    property int __pressY: -1
+
+    // The match this delegate was bound to, delegates may be reused for other matches, see ResultsModel::Roles
+    property string __matchKey
+
+    Component.onCompleted: {
+        __matchKey = rowMatchKey;
+        if (typeof listView.traceDelegate === "function") {
+            listView.traceDelegate();
+        }
+    }
+
+    ListView.onPooled: {
+        __pressed = false;
+        __pressX = -1;
+        __pressY = -1;
+    }
+
+    ListView.onReused: {
+        if (rowMatchKey !== __matchKey) {
+            activeAction = -1;
+        }
+        __matchKey = rowMatchKey;
+        if (typeof listView.traceDelegate === "function") {
+            listView.traceDelegate();
+        }
+    }
+
+    onIsCurrentChanged: {
+        if (!isCurrent) {
+            activeAction = -1
+        }
+    }
+
+    function activateNextAction() {
+        if (activeAction === additionalActions.length - 1) { // last action, do nothing
+            return false
+        }
+        ++activeAction
+        return true
+    }
+
+    function activatePreviousAction() {
+        if (activeAction < 0) { // no action, do nothing
+            return false
+        }
+        --activeAction
+        return true
+    }
+
+    function activateLastAction() {
+        activeAction = additionalActions.length - 1
+    }
+
+    acceptedButtons: Qt.LeftButton
+    hoverEnabled: true
+    onPressed: {
+        __pressed = true;
+        __pressX = mouse.x;
+        __pressY = mouse.y;
+    }
+
+    onReleased: {
+        if (__pressed) {
+            listView.currentIndex = model.index
+            listView.runCurrentIndex()
+        }
+
+        __pressed = false;
+        __pressX = -1;
+        __pressY = -1;
+    }
+
+    onPositionChanged: {
+        if (__pressX != -1 && typeof dragHelper !== "undefined" && dragHelper.isDrag(__pressX, __pressY, mouse.x, mouse.y)) {
+            var resultsModel = ListView.view.model;
+            var mimeData = resultsModel.getMimeData(resultsModel.index(index, 0));
+            if (mimeData) {
+                dragHelper.startDrag(resultDelegate, mimeData, rowIcon);
+                __pressed = false;
+                __pressX = -1;
+                __pressY = -1;
+            }
+        }
+
+        if (!listView.moved && listView.mouseMovedGlobally()) {
+            listView.moved = true
+            listView.currentIndex = index
+        }
+    }
+
+    onContainsMouseChanged: {
+        if (!containsMouse) {
+            __pressed = false;
+            __pressX = -1;
+            __pressY = -1;
+        } else {
+            // In case we display the history we have a QML ListView which does not have the moved property
+            if (!listView.hasOwnProperty("moved") || listView.moved) {
+                listView.currentIndex = index
+            } else if (listView.mouseMovedGlobally()) {
+                listView.moved = true
+                listView.currentIndex = index
+            }
+        }
+    }
+}
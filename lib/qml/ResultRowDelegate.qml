@@ -0,0 +1,66 @@
+/*
+ * This file is part of the KDE Milou Project
+ * SPDX-FileCopyrightText: 2026 Milou Authors
+ *
+ * SPDX-License-Identifier: LGPL-2.1-only OR LGPL-3.0-only OR LicenseRef-KDE-Accepted-LGPL
+ *
+ */
+
+import QtQuick 2.15
+
+import org.kde.plasma.core 2.0 as PlasmaCore
+import org.kde.milou 0.3 as Milou
+
+// Same interface as ResultDelegate but draws the row in C++,
+// only the current row creates items for its actions
+ResultDelegateBase {
+    id: resultDelegate
+
+    height: row.implicitHeight
+
+    Milou.ResultRow {
+        id: row
+        anchors.fill: parent
+
+        category: resultDelegate.typeText
+        text: resultDelegate.rowText
+        subtext: resultDelegate.rowSubtext
+        icon: resultDelegate.rowIcon
+        multiLine: resultDelegate.rowMultiLine
+
+        iconSize: units.iconSizes.smallMedium
+        categoryWidth: resultDelegate.categoryWidth
+        reservedWidth: actionsLoader.item ? actionsLoader.item.width + units.smallSpacing : 0
+        spacing: units.smallSpacing
+        font: theme.defaultFont
+        textColor: theme.textColor
+        secondaryTextColor: theme.disabledTextColor
+        current: resultDelegate.isCurrent
+        separatorVisible: resultDelegate.sectionHasChanged
+                       && !resultDelegate.isCurrent
+                       && (index === 0 || resultDelegate.ListView.view.currentIndex !== (index - (resultDelegate.reversed ? 0 : 1)))
+
+        Loader {
+            x: row.subtextRect.x
+            y: row.subtextRect.y
+            width: row.subtextRect.width
+            height: row.subtextRect.height
+            active: resultDelegate.containsMouse && row.subtextTruncated
+
+            sourceComponent: PlasmaCore.ToolTipArea {
+                subText: row.subtext
+                active: containsMouse
+                timeout: -1
+            }
+        }
+    }
+
+    Loader {
+        id: actionsLoader
+        anchors.right: parent.right
+        anchors.verticalCenter: parent.verticalCenter
+        active: resultDelegate.additionalActions.length > 0
+
+        sourceComponent: resultDelegate.actionsComponent
+    }
+}
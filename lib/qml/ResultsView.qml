@@ -6,7 +6,8 @@
  *
  */
 
-import QtQuick 2.1
+import QtQuick 2.15
+import QtQuick.Window 2.15
 
 import org.kde.plasma.components 2.0 as PlasmaComponents
 import org.kde.plasma.core 2.0 as PlasmaCore
@@ -22,6 +23,7 @@ ListView {
     property alias runnerIcon: resultModel.runnerIcon
     property alias querying: resultModel.querying
     property alias limit: resultModel.limit
+    property alias queryDebounce: resultModel.queryDebounce
     property bool reversed
     signal activated
     signal updateQueryString(string text, int cursorPosition)
@@ -40,16 +42,31 @@ ListView {
     }
 
     // This is used to keep track if the user has pressed enter before
-    // the first result has been shown, in the case the first result should
-    // be run when the model is populated
-    property bool runAutomatically
+    // the first result has been shown, in the case the best result should
+    // be run as soon as it is known
+    property bool runAutomatically: false
+    onRunAutomaticallyChanged: {
+        if (runAutomatically === resultModel.activationPending) {
+            return;
+        }
+        if (runAutomatically) {
+            resultModel.activateBestMatch();
+        } else {
+            resultModel.cancelActivation();
+        }
+    }
 
     // This is used to disable mouse selection if the user interacts only with keyboard
     property bool moved: false
-    property point savedMousePosition: Milou.MouseHelper.globalMousePosition()
     function mouseMovedGlobally() {
-        return savedMousePosition != Milou.MouseHelper.globalMousePosition();
+        return Milou.MouseHelper.movedSinceReset;
+    }
+    Component.onCompleted: {
+        Milou.MouseHelper.watchWindow(Window.window);
+        Milou.MouseHelper.resetMoved();
     }
+    // Only the events of our own window tell whether the mouse moved over the results
+    Window.onWindowChanged: Milou.MouseHelper.watchWindow(Window.window)
 
     Milou.DragHelper {
         id: dragHelper
@@ -78,31 +95,59 @@ ListView {
                     listView.currentIndex = 0;
                 });
             }
+        }
 
-            if (runAutomatically) {
-                // This needs to be delayed as running a result may close the window and clear the query
-                // having us reset the model whilst in the middle of processing the insertion.
-                // The proxy model chain that comes after us really doesn't like this.
-                Qt.callLater(function() {
-                    resultModel.run(resultModel.index(0, 0));
-                    listView.activated();
-                });
+        onActivationPendingChanged: {
+            listView.runAutomatically = activationPending;
+        }
 
-                runAutomatically = false;
+        onActivationFinished: {
+            if (success) {
+                listView.activated();
             }
         }
 
         function resetView() {
             listView.currentIndex = 0;
             listView.moved = false;
-            listView.savedMousePosition = Milou.MouseHelper.globalMousePosition();
+            Milou.MouseHelper.resetMoved();
+            listView.__delegateTraced = false;
         }
     }
 
-    delegate: ResultDelegate {
-        id: resultDelegate
-        width: listView.width
-        reversed: listView.reversed
+    // Marks when the results of a query start to show up, see ResultsModel::tracing
+    property bool __delegateTraced: false
+    function traceDelegate() {
+        if (resultModel.tracing && !__delegateTraced) {
+            __delegateTraced = true;
+            resultModel.traceInstant("first delegate");
+        }
+    }
+
+    // Draw the results in C++ rather than composing them out of QML items,
+    // which makes creating them a lot cheaper
+    property bool useNativeDelegate: false
+
+    delegate: useNativeDelegate ? nativeDelegateComponent : delegateComponent
+    // Results are replaced on every query, rebind existing delegates rather than creating new ones
+    reuseItems: true
+
+    Component {
+        id: delegateComponent
+
+        ResultDelegate {
+            width: listView.width
+            reversed: listView.reversed
+        }
+    }
+
+    Component {
+        id: nativeDelegateComponent
+
+        ResultRowDelegate {
+            width: listView.width
+            reversed: listView.reversed
+        }
     }
 
     //
@@ -115,9 +160,10 @@ ListView {
 
     function runCurrentIndex(event) {
         if (!currentItem) {
-            runAutomatically = true
+            resultModel.activateBestMatch()
             return;
         } else {
+            resultModel.cancelActivation()
             // If user presses Shift+Return to invoke an action, invoke the first runner action
             if (event && event.modifiers === Qt.ShiftModifier
                     && currentItem.additionalActions && currentItem.additionalActions.length > 0) {
@@ -133,7 +179,6 @@ ListView {
             if (resultModel.run(resultModel.index(currentIndex, 0))) {
                 activated()
             }
-            runAutomatically = false
         }
     }
 
@@ -201,6 +246,5 @@ ListView {
 
     function setQueryString(queryString) {
         resultModel.queryString = queryString
-        runAutomatically = false
     }
 }
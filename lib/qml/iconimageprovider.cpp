@@ -0,0 +1,324 @@
+/*
+ * This file is part of the KDE Milou Project
+ * SPDX-FileCopyrightText: 2026 Milou Authors
+ *
+ * SPDX-License-Identifier: LGPL-2.1-only OR LGPL-3.0-only OR LicenseRef-KDE-Accepted-LGPL
+ *
+ */
+
+#include "iconimageprovider.h"
+
+#include <QCoreApplication>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QIcon>
+#include <QMutexLocker>
+#include <QRunnable>
+#include <QThread>
+#include <QUrlQuery>
+
+using namespace Milou;
+
+// In KiB, enough for a few hundred icons at typical list sizes
+static const int s_maxCacheCost = 8 * 1024;
+static const int s_defaultIconSize = 22;
+static const int s_maxThreadCount = 2;
+
+namespace
+{
+// The icon theme and icon engines like KIconEngine aren't thread-safe and the GUI thread
+// uses them all the time, so icons are looked up and rendered on the GUI thread.
+// Only scaling them to the requested size is left to the pool.
+class IconRenderJob : public QObject, public QRunnable
+{
+    Q_OBJECT
+
+public:
+    IconRenderJob(const QString &name, const QSize &size, qreal devicePixelRatio, const QString &key, QMutex *pendingJobsMutex, QHash<QString, QObject *> *pendingJobs)
+        : m_name(name)
+        , m_size(size)
+        , m_devicePixelRatio(devicePixelRatio)
+        , m_key(key)
+        , m_pendingJobsMutex(pendingJobsMutex)
+        , m_pendingJobs(pendingJobs)
+    {
+        m_timer.start();
+    }
+
+    // Returns whether the image still needs to be scaled
+    bool render()
+    {
+        Q_ASSERT(QThread::currentThread() == qApp->thread());
+
+        // Some runners use the path of an icon rather than its name
+        const QIcon icon = QDir::isAbsolutePath(m_name) ? QIcon(m_name) : QIcon::fromTheme(m_name);
+        if (!icon.isNull()) {
+            m_image = icon.pixmap(m_size * m_devicePixelRatio).toImage();
+        }
+
+        if (m_image.isNull() || m_image.size() == m_size * m_devicePixelRatio) {
+            finish();
+            return false;
+        }
+        return true;
+    }
+
+    void run() override
+    {
+        m_image = m_image.scaled(m_size * m_devicePixelRatio, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+        finish();
+    }
+
+Q_SIGNALS:
+    void done(const QImage &image);
+
+private:
+    void finish()
+    {
+        m_image.setDevicePixelRatio(m_devicePixelRatio);
+        IconCache::instance()->insert(m_key, m_image, m_timer.nsecsElapsed());
+
+        // Requests coming in from now on find the image in the cache, those
+        // that were attached to this job are connected by the time it is done
+        QMutexLocker locker(m_pendingJobsMutex);
+        m_pendingJobs->remove(m_key);
+        Q_EMIT done(m_image);
+    }
+
+    QString m_name;
+    QSize m_size;
+    qreal m_devicePixelRatio;
+    QString m_key;
+    QMutex *m_pendingJobsMutex;
+    QHash<QString, QObject *> *m_pendingJobs;
+    QElapsedTimer m_timer;
+    QImage m_image;
+};
+
+class IconImageResponse : public QQuickImageResponse
+{
+public:
+    // The response may be deleted by the engine before the job is done,
+    // the connection makes sure the job never touches a deleted response
+    explicit IconImageResponse(IconRenderJob *job)
+    {
+        connect(job, &IconRenderJob::done, this, &IconImageResponse::setImage, Qt::QueuedConnection);
+    }
+
+    // For icons that are already in the cache
+    explicit IconImageResponse(const QImage &image)
+    {
+        // Can't emit finished right away, nobody is connected yet
+        QMetaObject::invokeMethod(
+            this,
+            [this, image] {
+                setImage(image);
+            },
+            Qt::QueuedConnection);
+    }
+
+    QQuickTextureFactory *textureFactory() const override
+    {
+        return QQuickTextureFactory::textureFactoryForImage(m_image);
+    }
+
+private:
+    void setImage(const QImage &image)
+    {
+        m_image = image;
+        Q_EMIT finished();
+    }
+
+    QImage m_image;
+};
+
+}
+
+IconCache::IconCache()
+    : m_images(s_maxCacheCost)
+{
+}
+
+IconCache *IconCache::instance()
+{
+    static IconCache s_instance;
+    return &s_instance;
+}
+
+QString IconCache::key(const QString &name, const QSize &size, qreal devicePixelRatio)
+{
+    return name + QLatin1Char('|') + QString::number(size.width()) + QLatin1Char('x') + QString::number(size.height()) + QLatin1Char('@')
+        + QString::number(devicePixelRatio);
+}
+
+QImage IconCache::image(const QString &key)
+{
+    QImage image;
+    {
+        QMutexLocker locker(&m_mutex);
+        if (const QImage *cachedImage = m_images.object(key)) {
+            image = *cachedImage;
+            ++m_hits;
+        }
+    }
+
+    if (!image.isNull()) {
+        notifyStatsChanged();
+    }
+    return image;
+}
+
+void IconCache::addHit()
+{
+    {
+        QMutexLocker locker(&m_mutex);
+        ++m_hits;
+    }
+    notifyStatsChanged();
+}
+
+void IconCache::insert(const QString &key, const QImage &image, qint64 decodeTimeNsecs)
+{
+    {
+        QMutexLocker locker(&m_mutex);
+        ++m_misses;
+        m_totalDecodeTime += decodeTimeNsecs;
+        m_maxDecodeTime = qMax(m_maxDecodeTime, decodeTimeNsecs);
+
+        if (!image.isNull()) {
+            m_images.insert(key, new QImage(image), qMax(1, int(image.sizeInBytes() / 1024)));
+        }
+    }
+
+    notifyStatsChanged();
+}
+
+int IconCache::hitCount() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_hits;
+}
+
+int IconCache::missCount() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_misses;
+}
+
+qreal IconCache::hitRate() const
+{
+    QMutexLocker locker(&m_mutex);
+    const int total = m_hits + m_misses;
+    return total > 0 ? qreal(m_hits) / total : 0.0;
+}
+
+qreal IconCache::averageDecodeTime() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_misses > 0 ? m_totalDecodeTime / qreal(m_misses) / 1000000.0 : 0.0;
+}
+
+qreal IconCache::maxDecodeTime() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_maxDecodeTime / 1000000.0;
+}
+
+void IconCache::resetStats()
+{
+    {
+        QMutexLocker locker(&m_mutex);
+        m_hits = 0;
+        m_misses = 0;
+        m_totalDecodeTime = 0;
+        m_maxDecodeTime = 0;
+    }
+    Q_EMIT statsChanged();
+}
+
+void IconCache::notifyStatsChanged()
+{
+    // The stats change from any thread and for every icon, tell the GUI thread once per event loop iteration
+    {
+        QMutexLocker locker(&m_mutex);
+        if (m_statsChangePending) {
+            return;
+        }
+        m_statsChangePending = true;
+    }
+
+    QMetaObject::invokeMethod(
+        this,
+        [this] {
+            {
+                QMutexLocker locker(&m_mutex);
+                m_statsChangePending = false;
+            }
+            Q_EMIT statsChanged();
+        },
+        Qt::QueuedConnection);
+}
+
+IconImageProvider::IconImageProvider()
+{
+    m_pool.setMaxThreadCount(s_maxThreadCount);
+}
+
+IconImageProvider::~IconImageProvider()
+{
+    m_pool.clear();
+    m_pool.waitForDone();
+}
+
+QQuickImageResponse *IconImageProvider::requestImageResponse(const QString &id, const QSize &requestedSize)
+{
+    const int queryStart = id.indexOf(QLatin1Char('?'));
+    const QString name = id.left(queryStart);
+
+    qreal devicePixelRatio = 1.0;
+    if (queryStart != -1) {
+        const QUrlQuery query(id.mid(queryStart + 1));
+        devicePixelRatio = qMax(1.0, query.queryItemValue(QStringLiteral("dpr")).toDouble());
+    }
+
+    QSize size = requestedSize;
+    if (size.width() <= 0 && size.height() <= 0) {
+        size = QSize(s_defaultIconSize, s_defaultIconSize);
+    } else if (size.width() <= 0) {
+        size.setWidth(size.height());
+    } else if (size.height() <= 0) {
+        size.setHeight(size.width());
+    }
+
+    const QString key = IconCache::key(name, size, devicePixelRatio);
+    const QImage cachedImage = IconCache::instance()->image(key);
+    if (!cachedImage.isNull()) {
+        return new IconImageResponse(cachedImage);
+    }
+
+    QMutexLocker locker(&m_pendingJobsMutex);
+
+    // Many rows usually show the same icon, render it once for all of them
+    if (auto *pendingJob = static_cast<IconRenderJob *>(m_pendingJobs.value(key))) {
+        IconCache::instance()->addHit();
+        return new IconImageResponse(pendingJob);
+    }
+
+    auto *job = new IconRenderJob(name, size, devicePixelRatio, key, &m_pendingJobsMutex, &m_pendingJobs);
+    m_pendingJobs.insert(key, job);
+    auto *response = new IconImageResponse(job);
+    // This is called on the image reader thread
+    QMetaObject::invokeMethod(
+        &m_guiThreadContext,
+        [this, job] {
+            if (job->render()) {
+                m_pool.start(job);
+            } else {
+                delete job;
+            }
+        },
+        Qt::QueuedConnection);
+    return response;
+}
+
+#include "iconimageprovider.moc"
@@ -0,0 +1,120 @@
+/*
+ * This file is part of the KDE Milou Project
+ * SPDX-FileCopyrightText: 2026 Milou Authors
+ *
+ * SPDX-License-Identifier: LGPL-2.1-only OR LGPL-3.0-only OR LicenseRef-KDE-Accepted-LGPL
+ *
+ */
+
+#pragma once
+
+#include <QCache>
+#include <QHash>
+#include <QImage>
+#include <QMutex>
+#include <QObject>
+#include <QQuickAsyncImageProvider>
+#include <QThreadPool>
+
+namespace Milou
+{
+/**
+ * Rendered theme icons, shared by all engines and kept across queries
+ *
+ * Icons are stored as QImage rather than QPixmap as they are
+ * scaled and handed to the engines outside of the GUI thread.
+ */
+class IconCache : public QObject
+{
+    Q_OBJECT
+
+    /**
+     * Number of icons that were served from the cache
+     */
+    Q_PROPERTY(int hitCount READ hitCount NOTIFY statsChanged)
+    /**
+     * Number of icons that had to be rendered
+     */
+    Q_PROPERTY(int missCount READ missCount NOTIFY statsChanged)
+    /**
+     * Share of icons served from the cache, between 0 and 1
+     */
+    Q_PROPERTY(qreal hitRate READ hitRate NOTIFY statsChanged)
+    /**
+     * Average time in milliseconds it took to look up and render an icon
+     */
+    Q_PROPERTY(qreal averageDecodeTime READ averageDecodeTime NOTIFY statsChanged)
+    /**
+     * Longest time in milliseconds it took to look up and render an icon
+     */
+    Q_PROPERTY(qreal maxDecodeTime READ maxDecodeTime NOTIFY statsChanged)
+
+public:
+    static IconCache *instance();
+
+    static QString key(const QString &name, const QSize &size, qreal devicePixelRatio);
+
+    /**
+     * The cached image for @p key, a null image if there is none
+     *
+     * This is thread-safe.
+     */
+    QImage image(const QString &key);
+    void insert(const QString &key, const QImage &image, qint64 decodeTimeNsecs);
+    /**
+     * Counts an icon that was served without rendering it again, e.g. along with an identical request
+     */
+    void addHit();
+
+    int hitCount() const;
+    int missCount() const;
+    qreal hitRate() const;
+    qreal averageDecodeTime() const;
+    qreal maxDecodeTime() const;
+
+    Q_INVOKABLE void resetStats();
+
+Q_SIGNALS:
+    void statsChanged();
+
+private:
+    IconCache();
+    void notifyStatsChanged();
+
+    mutable QMutex m_mutex;
+    QCache<QString, QImage> m_images;
+
+    int m_hits = 0;
+    int m_misses = 0;
+    qint64 m_totalDecodeTime = 0; // nsecs
+    qint64 m_maxDecodeTime = 0; // nsecs
+    bool m_statsChangePending = false;
+};
+
+/**
+ * Provides theme icons as "image://milouicon/<name>?dpr=<devicePixelRatio>"
+ *
+ * Icons are looked up and rendered on the GUI thread once the delegate that
+ * asked for them was created, as the icon theme isn't thread-safe, and scaled
+ * to the requested size on a thread pool if the theme doesn't have that size.
+ * Requests for an icon that is still being rendered share its result.
+ */
+class IconImageProvider : public QQuickAsyncImageProvider
+{
+public:
+    IconImageProvider();
+    ~IconImageProvider() override;
+
+    QQuickImageResponse *requestImageResponse(const QString &id, const QSize &requestedSize) override;
+
+private:
+    QThreadPool m_pool;
+    // Lives on the GUI thread, where icons are rendered
+    QObject m_guiThreadContext;
+
+    // Icons being rendered by key, identical requests share them
+    QMutex m_pendingJobsMutex;
+    QHash<QString, QObject *> m_pendingJobs;
+};
+
+} // namespace Milou
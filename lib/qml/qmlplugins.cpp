@@ -9,15 +9,22 @@
 #include "qmlplugins.h"
 
 #include "draghelper.h"
+#include "heightsettler.h"
+#include "iconimageprovider.h"
 #include "mousehelper.h"
+#include "pipelinestats.h"
+#include "resultrowitem.h"
 #include "resultsmodel.h"
 #include "sourcesmodel.h"
 
 #include <QMimeData>
 #include <QQmlEngine>
 
-void QmlPlugins::initializeEngine(QQmlEngine *, const char *)
+void QmlPlugins::initializeEngine(QQmlEngine *engine, const char *)
 {
+    if (!engine->imageProvider(QStringLiteral("milouicon"))) {
+        engine->addImageProvider(QStringLiteral("milouicon"), new Milou::IconImageProvider());
+    }
 }
 
 void QmlPlugins::registerTypes(const char *uri)
@@ -25,8 +32,16 @@ void QmlPlugins::registerTypes(const char *uri)
     qmlRegisterType<Milou::SourcesModel>(uri, 0, 1, "SourcesModel");
     qmlRegisterType<Milou::ResultsModel>(uri, 0, 3, "ResultsModel");
     qmlRegisterType<Milou::DragHelper>(uri, 0, 2, "DragHelper");
+    qmlRegisterType<Milou::ResultRowItem>(uri, 0, 3, "ResultRow");
+    qmlRegisterType<Milou::HeightSettler>(uri, 0, 3, "HeightSettler");
     qmlRegisterSingletonType<Milou::MouseHelper>(uri, 0, 1, "MouseHelper", [](QQmlEngine *, QJSEngine *) -> QObject * {
         return new Milou::MouseHelper();
     });
+    qmlRegisterSingletonType<Milou::IconCache>(uri, 0, 3, "IconCache", [](QQmlEngine *, QJSEngine *) -> QObject * {
+        // Shared by all engines
+        QQmlEngine::setObjectOwnership(Milou::IconCache::instance(), QQmlEngine::CppOwnership);
+        return Milou::IconCache::instance();
+    });
+    qmlRegisterUncreatableType<Milou::PipelineStats>(uri, 0, 3, "PipelineStats", QStringLiteral("Use ResultsModel.pipelineStats"));
     qmlRegisterAnonymousType<QMimeData>(uri, 0);
 }
@@ -0,0 +1,60 @@
+/*
+ * This file is part of the KDE Milou Project
+ * SPDX-FileCopyrightText: 2026 Milou Authors
+ *
+ * SPDX-License-Identifier: LGPL-2.1-only OR LGPL-3.0-only OR LicenseRef-KDE-Accepted-LGPL
+ *
+ */
+
+#include "querydebouncer.h"
+
+#include <QtGlobal>
+
+using namespace Milou;
+
+// weight of the newest sample in the moving averages
+static const qreal s_smoothing = 0.3;
+
+int QueryDebouncer::nextDelay(bool hadInformationalMatches)
+{
+    const qint64 interval = m_sinceLastKeystroke.isValid() ? m_sinceLastKeystroke.restart() : -1;
+    if (!m_sinceLastKeystroke.isValid()) {
+        m_sinceLastKeystroke.start();
+    }
+
+    int delay = s_minDelay;
+
+    if (interval >= 0 && interval < s_typingPause) {
+        if (m_typingInterval < 0) {
+            m_typingInterval = interval;
+        } else {
+            m_typingInterval = (1 - s_smoothing) * m_typingInterval + s_smoothing * interval;
+        }
+
+        // Wait a bit longer than the user usually takes for the next character
+        delay = qBound(s_minDelay, qRound(m_typingInterval * 1.2), s_maxDelay);
+    } else {
+        // Typing (re)started after a pause, don't keep the user waiting
+        m_typingInterval = -1;
+    }
+
+    // No point in waiting for more keystrokes longer than it takes the runners to answer
+    if (m_runnerLatency >= 0) {
+        delay = qMin(delay, qMax(s_minDelay, qRound(m_runnerLatency)));
+    }
+
+    if (hadInformationalMatches) {
+        delay = qMin(delay, s_informationalDelay);
+    }
+
+    return delay;
+}
+
+void QueryDebouncer::addRunnerLatency(int msecs)
+{
+    if (m_runnerLatency < 0) {
+        m_runnerLatency = msecs;
+    } else {
+        m_runnerLatency = (1 - s_smoothing) * m_runnerLatency + s_smoothing * msecs;
+    }
+}
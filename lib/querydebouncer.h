@@ -0,0 +1,53 @@
+/*
+ * This file is part of the KDE Milou Project
+ * SPDX-FileCopyrightText: 2026 Milou Authors
+ *
+ * SPDX-License-Identifier: LGPL-2.1-only OR LGPL-3.0-only OR LicenseRef-KDE-Accepted-LGPL
+ *
+ */
+
+#pragma once
+
+#include <QElapsedTimer>
+
+namespace Milou
+{
+/**
+ * Decides how long to wait before launching a typed query
+ *
+ * The delay follows the typing cadence: the first keystroke after a pause
+ * is launched almost immediately whereas during a burst of typing we wait
+ * roughly as long as it takes the user to type the next character.
+ * It never waits longer than the runners usually take to answer and
+ * stays short when the last query was answered by an informational match,
+ * e.g. a calculator result that updates with every keystroke.
+ */
+class QueryDebouncer
+{
+public:
+    /**
+     * Notes down a keystroke and returns the delay in milliseconds
+     * after which the query should be launched
+     */
+    int nextDelay(bool hadInformationalMatches);
+
+    /**
+     * Feeds how long it took for the runners to answer a query
+     */
+    void addRunnerLatency(int msecs);
+
+    static constexpr int s_fixedDelay = 200;
+
+private:
+    static constexpr int s_minDelay = 20;
+    static constexpr int s_maxDelay = 300;
+    static constexpr int s_informationalDelay = 50;
+    // a longer break than this starts a new burst of typing
+    static constexpr int s_typingPause = 600;
+
+    QElapsedTimer m_sinceLastKeystroke;
+    qreal m_typingInterval = -1;
+    qreal m_runnerLatency = -1;
+};
+
+} // namespace Milou
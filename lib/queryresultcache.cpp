@@ -0,0 +1,238 @@
+/*
+ * This file is part of the KDE Milou Project
+ * SPDX-FileCopyrightText: 2026 Milou Authors
+ *
+ * SPDX-License-Identifier: LGPL-2.1-only OR LGPL-3.0-only OR LicenseRef-KDE-Accepted-LGPL
+ *
+ */
+
+#include "queryresultcache.h"
+
+#include <QDataStream>
+#include <QDateTime>
+#include <QDir>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QStandardPaths>
+
+#include <algorithm>
+#include <cstring>
+
+using namespace Milou;
+
+static const quint32 s_magic = 0x4d4c5143; // MLQC
+static const quint32 s_version = 2;
+
+struct FileHeader {
+    quint32 magic;
+    quint32 version;
+    qint64 configLastModified;
+    qint64 configSize;
+};
+
+QueryResultCache::QueryResultCache(const QString &fileName)
+    : m_file(fileName)
+{
+}
+
+QueryResultCache::~QueryResultCache()
+{
+    if (m_data) {
+        m_file.unmap(m_data);
+    }
+}
+
+QString QueryResultCache::defaultFileName()
+{
+    return QStandardPaths::writableLocation(QStandardPaths::GenericCacheLocation) + QLatin1String("/milou/queryresults");
+}
+
+QString QueryResultCache::normalized(const QString &query)
+{
+    return query.trimmed().toLower();
+}
+
+QueryResultCache::ConfigVersion QueryResultCache::configVersion()
+{
+    ConfigVersion version;
+    const QFileInfo info(QStandardPaths::locate(QStandardPaths::ConfigLocation, QStringLiteral("krunnerrc")));
+    if (info.exists()) {
+        version.lastModified = info.lastModified().toMSecsSinceEpoch();
+        version.size = info.size();
+    }
+    return version;
+}
+
+void QueryResultCache::load()
+{
+    if (m_loaded) {
+        return;
+    }
+    m_loaded = true;
+
+    if (!m_file.open(QIODevice::ReadOnly)) {
+        return;
+    }
+
+    m_size = m_file.size();
+    m_data = m_size > 0 ? m_file.map(0, m_size) : nullptr;
+    if (!m_data || m_size < qint64(sizeof(FileHeader))) {
+        return;
+    }
+
+    FileHeader header;
+    std::memcpy(&header, m_data, sizeof(FileHeader));
+
+    const ConfigVersion version = configVersion();
+    if (header.magic != s_magic || header.version != s_version
+        || header.configLastModified != version.lastModified || header.configSize != version.size) {
+        // Written by another version or with a different runner configuration
+        return;
+    }
+
+    qint64 offset = sizeof(FileHeader);
+    QString key;
+    while (readEntry(offset, &key, nullptr)) {
+        m_index.insert(key, offset);
+
+        quint32 size;
+        std::memcpy(&size, m_data + offset, sizeof(quint32));
+        offset += size;
+    }
+}
+
+bool QueryResultCache::readEntry(qint64 offset, QString *key, Entry *entry) const
+{
+    if (!m_data || offset + qint64(sizeof(quint32)) > m_size) {
+        return false;
+    }
+
+    quint32 size;
+    std::memcpy(&size, m_data + offset, sizeof(quint32));
+    if (size <= sizeof(quint32) || offset + size > m_size) {
+        return false;
+    }
+
+    const QByteArray payload = QByteArray::fromRawData(reinterpret_cast<const char *>(m_data + offset + sizeof(quint32)), size - sizeof(quint32));
+    QDataStream stream(payload);
+    stream.setVersion(QDataStream::Qt_5_15);
+
+    stream >> *key;
+    // Only decode the matches when they're actually needed
+    if (entry) {
+        stream >> entry->count >> entry->matches;
+    }
+    return stream.status() == QDataStream::Ok;
+}
+
+QueryResultCache::Entry QueryResultCache::entry(const QString &key) const
+{
+    const auto it = m_entries.constFind(key);
+    if (it != m_entries.constEnd()) {
+        return *it;
+    }
+
+    Entry entry;
+    const qint64 offset = m_index.value(key, -1);
+    if (offset >= 0) {
+        QString storedKey;
+        readEntry(offset, &storedKey, &entry);
+    }
+    return entry;
+}
+
+QVector<StoredMatch> QueryResultCache::matches(const QString &query)
+{
+    load();
+
+    const QString key = normalized(query);
+    if (!m_entries.contains(key) && !m_index.contains(key)) {
+        return {};
+    }
+    return entry(key).matches;
+}
+
+void QueryResultCache::insert(const QString &query, const QVector<StoredMatch> &matches)
+{
+    load();
+
+    const QString key = normalized(query);
+    if (key.size() < s_minQueryLength) {
+        return;
+    }
+
+    Entry updated = entry(key);
+    updated.matches = matches.mid(0, s_maxMatchesPerQuery);
+    m_entries.insert(key, updated);
+    m_dirty = true;
+}
+
+void QueryResultCache::recordUse(const QString &query)
+{
+    load();
+
+    const QString key = normalized(query);
+    if (key.size() < s_minQueryLength) {
+        return;
+    }
+
+    // The results may only be inserted once the query finished
+    Entry used = entry(key);
+    ++used.count;
+    m_entries.insert(key, used);
+    m_dirty = true;
+}
+
+void QueryResultCache::save()
+{
+    if (!m_dirty) {
+        return;
+    }
+
+    // Merge what we used or changed with what was on disk
+    QHash<QString, Entry> entries = m_entries;
+    for (auto it = m_index.constBegin(); it != m_index.constEnd(); ++it) {
+        if (!entries.contains(it.key())) {
+            entries.insert(it.key(), entry(it.key()));
+        }
+    }
+
+    QStringList keys;
+    for (auto it = entries.constBegin(); it != entries.constEnd(); ++it) {
+        // Used, but the results never came in
+        if (!it->matches.isEmpty()) {
+            keys.append(it.key());
+        }
+    }
+    std::sort(keys.begin(), keys.end(), [&entries](const QString &a, const QString &b) {
+        return entries.value(a).count > entries.value(b).count;
+    });
+    keys = keys.mid(0, s_maxEntries);
+
+    QDir().mkpath(QFileInfo(m_file.fileName()).absolutePath());
+    QSaveFile file(m_file.fileName());
+    if (!file.open(QIODevice::WriteOnly)) {
+        return;
+    }
+
+    const ConfigVersion version = configVersion();
+    const FileHeader header{s_magic, s_version, version.lastModified, version.size};
+    file.write(reinterpret_cast<const char *>(&header), sizeof(FileHeader));
+
+    for (const QString &key : qAsConst(keys)) {
+        const Entry &entry = entries[key];
+
+        QByteArray payload;
+        QDataStream stream(&payload, QIODevice::WriteOnly);
+        stream.setVersion(QDataStream::Qt_5_15);
+        stream << key << entry.count << entry.matches;
+
+        const quint32 size = sizeof(quint32) + payload.size();
+        file.write(reinterpret_cast<const char *>(&size), sizeof(quint32));
+        file.write(payload);
+    }
+
+    if (file.commit()) {
+        m_dirty = false;
+    }
+}
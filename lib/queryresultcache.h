@@ -0,0 +1,94 @@
+/*
+ * This file is part of the KDE Milou Project
+ * SPDX-FileCopyrightText: 2026 Milou Authors
+ *
+ * SPDX-License-Identifier: LGPL-2.1-only OR LGPL-3.0-only OR LicenseRef-KDE-Accepted-LGPL
+ *
+ */
+
+#pragma once
+
+#include <QFile>
+#include <QHash>
+#include <QVector>
+
+#include "storedmatch.h"
+
+namespace Milou
+{
+/**
+ * Remembers the top results of frequently typed queries across sessions
+ *
+ * This allows showing results instantly after login while the runners,
+ * whose caches are still cold, take their time to answer.
+ *
+ * The cache file is memory-mapped when it's first needed and entries are
+ * only decoded when they're looked up. The file is tied to the krunnerrc
+ * it was written with, once the runner configuration changes it is discarded.
+ */
+class QueryResultCache
+{
+public:
+    explicit QueryResultCache(const QString &fileName = defaultFileName());
+    ~QueryResultCache();
+
+    static QString defaultFileName();
+
+    /**
+     * The cached results for @p query, empty if there are none
+     */
+    QVector<StoredMatch> matches(const QString &query);
+
+    /**
+     * Caches the results of @p query, unless it is too short to be worth it
+     */
+    void insert(const QString &query, const QVector<StoredMatch> &matches);
+
+    /**
+     * Counts a use of @p query, e.g. when it finished or a result was run from it
+     *
+     * Only the most used queries are kept, looking one up while typing doesn't count.
+     */
+    void recordUse(const QString &query);
+
+    /**
+     * Writes the most frequently used entries to disk
+     */
+    void save();
+
+    static constexpr int s_maxMatchesPerQuery = 10;
+    static constexpr int s_maxEntries = 200;
+    // Shorter queries are mostly what is typed on the way to a longer one
+    static constexpr int s_minQueryLength = 3;
+
+private:
+    struct Entry {
+        quint32 count = 0;
+        QVector<StoredMatch> matches;
+    };
+
+    struct ConfigVersion {
+        qint64 lastModified = 0;
+        qint64 size = 0;
+    };
+
+    static QString normalized(const QString &query);
+    static ConfigVersion configVersion();
+
+    void load();
+    bool readEntry(qint64 offset, QString *key, Entry *entry) const;
+    Entry entry(const QString &key) const;
+
+    QFile m_file;
+    bool m_loaded = false;
+    bool m_dirty = false;
+    uchar *m_data = nullptr;
+    qint64 m_size = 0;
+
+    // Entries in the mapped file
+    QHash<QString /*query*/, qint64 /*offset*/> m_index;
+    // Entries used or changed since loading
+    QHash<QString /*query*/, Entry> m_entries;
+};
+
+} // namespace Milou
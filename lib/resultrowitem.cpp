@@ -0,0 +1,565 @@
+/*
+ * This file is part of the KDE Milou Project
+ * SPDX-FileCopyrightText: 2026 Milou Authors
+ *
+ * SPDX-License-Identifier: LGPL-2.1-only OR LGPL-3.0-only OR LicenseRef-KDE-Accepted-LGPL
+ *
+ */
+
+#include "resultrowitem.h"
+
+#include <QDir>
+#include <QFontMetricsF>
+#include <QGuiApplication>
+#include <QPainter>
+#include <QQuickWindow>
+#include <QSGOpacityNode>
+#include <QSGSimpleTextureNode>
+
+#include <cmath>
+#include <functional>
+
+using namespace Milou;
+
+// ResultDelegate.qml tints category and subtext of the current row with the text color
+// at this opacity, blending the text color over them at that opacity comes close
+static const qreal s_currentHighlightOpacity = 0.4;
+
+namespace
+{
+class RowNode : public QSGNode
+{
+public:
+    RowNode()
+        : row(new QSGSimpleTextureNode)
+        , secondary(new QSGSimpleTextureNode)
+        , highlightOpacity(new QSGOpacityNode)
+        , highlight(new QSGSimpleTextureNode)
+    {
+        for (QSGSimpleTextureNode *node : {row, secondary, highlight}) {
+            node->setOwnsTexture(true);
+        }
+
+        // Owned by their parents
+        appendChildNode(row);
+        appendChildNode(secondary);
+        appendChildNode(highlightOpacity);
+        highlightOpacity->appendChildNode(highlight);
+    }
+
+    QSGSimpleTextureNode *row;
+    QSGSimpleTextureNode *secondary;
+    QSGOpacityNode *highlightOpacity;
+    QSGSimpleTextureNode *highlight;
+};
+}
+
+bool ResultRowItem::CachedTextLayout::update(const QString &text, const QFont &font, qreal width, bool wrap)
+{
+    if (text == m_text && font == m_font && qFuzzyCompare(width + 1, m_width + 1) && wrap == m_wrap) {
+        return false;
+    }
+
+    m_text = text;
+    m_font = font;
+    m_width = width;
+    m_wrap = wrap;
+
+    m_layout.clearLayout();
+    m_size = QSizeF();
+    m_elided = false;
+
+    if (text.isEmpty() || width <= 0) {
+        m_layout.setText(QString());
+        m_elided = !text.isEmpty();
+        return true;
+    }
+
+    if (wrap) {
+        m_layout.setText(text);
+    } else {
+        QString singleLineText = text;
+        singleLineText.replace(QLatin1Char('\n'), QLatin1Char(' '));
+        const QString elidedText = QFontMetricsF(font).elidedText(singleLineText, Qt::ElideMiddle, width);
+        m_elided = elidedText != singleLineText;
+        m_layout.setText(elidedText);
+    }
+
+    QTextOption option;
+    option.setWrapMode(wrap ? QTextOption::WrapAtWordBoundaryOrAnywhere : QTextOption::NoWrap);
+    m_layout.setTextOption(option);
+    m_layout.setFont(font);
+    m_layout.setCacheEnabled(true);
+
+    qreal height = 0;
+    qreal naturalWidth = 0;
+    m_layout.beginLayout();
+    for (QTextLine line = m_layout.createLine(); line.isValid(); line = m_layout.createLine()) {
+        line.setLineWidth(width);
+        line.setPosition(QPointF(0, height));
+        height += line.height();
+        naturalWidth = qMax(naturalWidth, line.naturalTextWidth());
+    }
+    m_layout.endLayout();
+
+    m_size = QSizeF(naturalWidth, height);
+    return true;
+}
+
+void ResultRowItem::CachedTextLayout::draw(QPainter *painter, const QPointF &pos) const
+{
+    if (!m_size.isEmpty()) {
+        m_layout.draw(painter, pos);
+    }
+}
+
+QSizeF ResultRowItem::CachedTextLayout::size() const
+{
+    return m_size;
+}
+
+bool ResultRowItem::CachedTextLayout::isElided() const
+{
+    return m_elided;
+}
+
+ResultRowItem::ResultRowItem(QQuickItem *parent)
+    : QQuickItem(parent)
+    , m_font(QGuiApplication::font())
+{
+    setFlag(ItemHasContents);
+    relayout();
+}
+
+ResultRowItem::~ResultRowItem() = default;
+
+QString ResultRowItem::category() const
+{
+    return m_category;
+}
+
+void ResultRowItem::setCategory(const QString &category)
+{
+    if (m_category != category) {
+        m_category = category;
+        relayout();
+        Q_EMIT categoryChanged();
+    }
+}
+
+QString ResultRowItem::text() const
+{
+    return m_text;
+}
+
+void ResultRowItem::setText(const QString &text)
+{
+    if (m_text != text) {
+        m_text = text;
+        relayout();
+        Q_EMIT textChanged();
+    }
+}
+
+QString ResultRowItem::subtext() const
+{
+    return m_subtext;
+}
+
+void ResultRowItem::setSubtext(const QString &subtext)
+{
+    if (m_subtext != subtext) {
+        m_subtext = subtext;
+        relayout();
+        Q_EMIT subtextChanged();
+    }
+}
+
+QVariant ResultRowItem::icon() const
+{
+    return m_icon;
+}
+
+void ResultRowItem::setIcon(const QVariant &icon)
+{
+    // QIcons don't compare meaningfully, only skip unchanged icon names
+    if (icon.userType() == QMetaType::QString && m_icon.userType() == QMetaType::QString && icon.toString() == m_icon.toString()) {
+        return;
+    }
+
+    m_icon = icon;
+    m_iconDirty = true;
+    invalidate(RowLayer);
+    Q_EMIT iconChanged();
+}
+
+int ResultRowItem::iconSize() const
+{
+    return m_iconSize;
+}
+
+void ResultRowItem::setIconSize(int size)
+{
+    if (m_iconSize != size) {
+        m_iconSize = size;
+        m_iconDirty = true;
+        relayout();
+        invalidate(AllLayers);
+        Q_EMIT iconSizeChanged();
+    }
+}
+
+int ResultRowItem::categoryWidth() const
+{
+    return m_categoryWidth;
+}
+
+void ResultRowItem::setCategoryWidth(int width)
+{
+    if (m_categoryWidth != width) {
+        m_categoryWidth = width;
+        relayout();
+        invalidate(AllLayers);
+        Q_EMIT categoryWidthChanged();
+    }
+}
+
+qreal ResultRowItem::reservedWidth() const
+{
+    return m_reservedWidth;
+}
+
+void ResultRowItem::setReservedWidth(qreal width)
+{
+    if (!qFuzzyCompare(m_reservedWidth + 1, width + 1)) {
+        m_reservedWidth = width;
+        relayout();
+        Q_EMIT reservedWidthChanged();
+    }
+}
+
+int ResultRowItem::spacing() const
+{
+    return m_spacing;
+}
+
+void ResultRowItem::setSpacing(int spacing)
+{
+    if (m_spacing != spacing) {
+        m_spacing = spacing;
+        relayout();
+        invalidate(AllLayers);
+        Q_EMIT spacingChanged();
+    }
+}
+
+QFont ResultRowItem::font() const
+{
+    return m_font;
+}
+
+void ResultRowItem::setFont(const QFont &font)
+{
+    if (m_font != font) {
+        m_font = font;
+        relayout();
+        Q_EMIT fontChanged();
+    }
+}
+
+QColor ResultRowItem::textColor() const
+{
+    return m_textColor;
+}
+
+void ResultRowItem::setTextColor(const QColor &color)
+{
+    if (m_textColor != color) {
+        m_textColor = color;
+        invalidate(AllLayers);
+        Q_EMIT textColorChanged();
+    }
+}
+
+QColor ResultRowItem::secondaryTextColor() const
+{
+    return m_secondaryTextColor;
+}
+
+void ResultRowItem::setSecondaryTextColor(const QColor &color)
+{
+    if (m_secondaryTextColor != color) {
+        m_secondaryTextColor = color;
+        invalidate(AllLayers);
+        Q_EMIT secondaryTextColorChanged();
+    }
+}
+
+bool ResultRowItem::isCurrent() const
+{
+    return m_current;
+}
+
+void ResultRowItem::setCurrent(bool current)
+{
+    if (m_current != current) {
+        m_current = current;
+        // Only the opacity of the highlight changes
+        update();
+        Q_EMIT currentChanged();
+    }
+}
+
+bool ResultRowItem::isMultiLine() const
+{
+    return m_multiLine;
+}
+
+void ResultRowItem::setMultiLine(bool multiLine)
+{
+    if (m_multiLine != multiLine) {
+        m_multiLine = multiLine;
+        relayout();
+        Q_EMIT multiLineChanged();
+    }
+}
+
+bool ResultRowItem::isSeparatorVisible() const
+{
+    return m_separatorVisible;
+}
+
+void ResultRowItem::setSeparatorVisible(bool visible)
+{
+    if (m_separatorVisible != visible) {
+        m_separatorVisible = visible;
+        invalidate(RowLayer);
+        Q_EMIT separatorVisibleChanged();
+    }
+}
+
+void ResultRowItem::geometryChanged(const QRectF &newGeometry, const QRectF &oldGeometry)
+{
+    QQuickItem::geometryChanged(newGeometry, oldGeometry);
+
+    if (newGeometry.size() != oldGeometry.size()) {
+        relayout();
+        invalidate(AllLayers);
+    }
+}
+
+void ResultRowItem::itemChange(ItemChange change, const ItemChangeData &value)
+{
+    if (change == ItemSceneChange || change == ItemDevicePixelRatioHasChanged) {
+        m_iconDirty = true;
+        invalidate(AllLayers);
+    }
+
+    QQuickItem::itemChange(change, value);
+}
+
+qreal ResultRowItem::textStart() const
+{
+    return m_categoryWidth + m_iconSize + m_spacing;
+}
+
+qreal ResultRowItem::devicePixelRatio() const
+{
+    return window() ? window()->effectiveDevicePixelRatio() : qGuiApp->devicePixelRatio();
+}
+
+bool ResultRowItem::isSubtextTruncated() const
+{
+    return m_subtextTruncated;
+}
+
+QRectF ResultRowItem::subtextRect() const
+{
+    return m_subtextRect;
+}
+
+void ResultRowItem::invalidate(int layers)
+{
+    if (layers) {
+        m_dirtyLayers |= layers;
+        polish();
+    }
+}
+
+void ResultRowItem::relayout()
+{
+    const bool categoryChanged = m_categoryLayout.update(m_category, m_font, m_categoryWidth - 2 * m_spacing, false);
+
+    const qreal textWidth = width() - m_reservedWidth - textStart() - m_spacing;
+    const bool textChanged = m_textLayout.update(m_text, m_font, textWidth, m_multiLine);
+    const bool subtextChanged = m_subtextLayout.update(m_subtext, m_font, textWidth - m_textLayout.size().width() - m_spacing, false);
+
+    const qreal textHeight = qMax(QFontMetricsF(m_font).height(), m_textLayout.size().height());
+    setImplicitHeight(std::ceil(qMax<qreal>(m_iconSize, textHeight) + 2 * m_spacing));
+
+    const QSizeF subtextSize = m_subtextLayout.size();
+    const QRectF subtextRect(QPointF(textStart() + m_textLayout.size().width() + m_spacing, (height() - subtextSize.height()) / 2), subtextSize);
+    if (m_subtextRect != subtextRect) {
+        m_subtextRect = subtextRect;
+        Q_EMIT subtextRectChanged();
+    }
+    if (m_subtextTruncated != m_subtextLayout.isElided()) {
+        m_subtextTruncated = m_subtextLayout.isElided();
+        Q_EMIT subtextTruncatedChanged();
+    }
+
+    // The subtext starts where the text ends
+    invalidate((textChanged ? AllLayers : 0) | (categoryChanged || subtextChanged ? SecondaryLayer : 0));
+}
+
+void ResultRowItem::paintRow(QPainter *painter)
+{
+    const qreal rowHeight = height();
+
+    if (m_separatorVisible) {
+        QColor separatorColor = m_secondaryTextColor;
+        separatorColor.setAlphaF(0.3);
+        painter->setPen(separatorColor);
+        painter->drawLine(QLineF(m_categoryWidth, 0.5, width(), 0.5));
+    }
+
+    if (!m_iconImage.isNull()) {
+        painter->drawImage(QRectF(m_categoryWidth, (rowHeight - m_iconSize) / 2, m_iconSize, m_iconSize), m_iconImage);
+    }
+
+    painter->setPen(m_textColor);
+    m_textLayout.draw(painter, QPointF(textStart(), (rowHeight - m_textLayout.size().height()) / 2));
+}
+
+QRectF ResultRowItem::categoryRect() const
+{
+    const QSizeF categorySize = m_categoryLayout.size();
+    return QRectF(QPointF(m_categoryWidth - 2 * m_spacing - categorySize.width(), (height() - categorySize.height()) / 2), categorySize);
+}
+
+QRectF ResultRowItem::secondaryRect() const
+{
+    QRectF rect;
+    for (const QRectF &textRect : {categoryRect(), m_subtextRect}) {
+        if (!textRect.isEmpty()) {
+            rect = rect.united(textRect);
+        }
+    }
+    if (rect.isEmpty()) {
+        return QRectF();
+    }
+
+    // Leave room for antialiasing and round outwards so the texture isn't scaled
+    const qreal dpr = devicePixelRatio();
+    rect = rect.adjusted(-1, -1, 1, 1).intersected(boundingRect());
+    return QRectF(QPointF(std::floor(rect.left() * dpr), std::floor(rect.top() * dpr)) / dpr,
+                  QPointF(std::ceil(rect.right() * dpr), std::ceil(rect.bottom() * dpr)) / dpr);
+}
+
+void ResultRowItem::paintSecondary(QPainter *painter, const QColor &color)
+{
+    painter->setPen(color);
+    painter->translate(-m_secondaryRect.topLeft());
+
+    m_categoryLayout.draw(painter, categoryRect().topLeft());
+
+    m_subtextLayout.draw(painter, m_subtextRect.topLeft());
+}
+
+void ResultRowItem::updatePolish()
+{
+    const qreal dpr = devicePixelRatio();
+    const QSize pixelSize = (size() * dpr).toSize();
+
+    if (pixelSize.isEmpty()) {
+        m_image = QImage();
+        m_secondaryImage = QImage();
+        m_highlightImage = QImage();
+        m_secondaryRect = QRectF();
+        m_dirtyLayers = AllLayers;
+        update();
+        return;
+    }
+
+    const auto paintImage = [dpr](QImage *image, const QSize &pixelSize, const std::function<void(QPainter *)> &paint) {
+        *image = QImage(pixelSize, QImage::Format_ARGB32_Premultiplied);
+        image->setDevicePixelRatio(dpr);
+        image->fill(Qt::transparent);
+
+        QPainter painter(image);
+        painter.setRenderHint(QPainter::SmoothPixmapTransform);
+        paint(&painter);
+    };
+
+    if (m_dirtyLayers & RowLayer) {
+        if (m_iconDirty) {
+            m_iconDirty = false;
+
+            QIcon icon;
+            if (m_icon.userType() == qMetaTypeId<QIcon>()) {
+                icon = m_icon.value<QIcon>();
+            } else {
+                const QString name = m_icon.toString();
+                if (!name.isEmpty()) {
+                    icon = QDir::isAbsolutePath(name) ? QIcon(name) : QIcon::fromTheme(name);
+                }
+            }
+
+            m_iconImage = icon.isNull() ? QImage() : icon.pixmap(window(), QSize(m_iconSize, m_iconSize)).toImage();
+        }
+
+        paintImage(&m_image, pixelSize, [this](QPainter *painter) {
+            paintRow(painter);
+        });
+    }
+
+    if (m_dirtyLayers & SecondaryLayer) {
+        // Most of the row has neither, a texture is needed even when both are empty
+        m_secondaryRect = secondaryRect();
+        const QSize secondaryPixelSize = (m_secondaryRect.size() * dpr).toSize().expandedTo(QSize(1, 1));
+
+        paintImage(&m_secondaryImage, secondaryPixelSize, [this](QPainter *painter) {
+            paintSecondary(painter, m_secondaryTextColor);
+        });
+        paintImage(&m_highlightImage, secondaryPixelSize, [this](QPainter *painter) {
+            paintSecondary(painter, m_textColor);
+        });
+    }
+
+    m_changedLayers |= m_dirtyLayers;
+    m_dirtyLayers = 0;
+    update();
+}
+
+QSGNode *ResultRowItem::updatePaintNode(QSGNode *oldNode, UpdatePaintNodeData *data)
+{
+    Q_UNUSED(data);
+
+    auto *node = static_cast<RowNode *>(oldNode);
+
+    if (m_image.isNull()) {
+        delete node;
+        return nullptr;
+    }
+
+    if (!node) {
+        node = new RowNode();
+        m_changedLayers = AllLayers;
+    }
+
+    if (m_changedLayers & RowLayer) {
+        node->row->setTexture(window()->createTextureFromImage(m_image));
+    }
+    if (m_changedLayers & SecondaryLayer) {
+        node->secondary->setTexture(window()->createTextureFromImage(m_secondaryImage));
+        node->highlight->setTexture(window()->createTextureFromImage(m_highlightImage));
+    }
+    m_changedLayers = 0;
+
+    node->row->setRect(boundingRect());
+    node->secondary->setRect(m_secondaryRect);
+    node->highlight->setRect(m_secondaryRect);
+    node->highlightOpacity->setOpacity(m_current ? s_currentHighlightOpacity : 0.0);
+
+    return node;
+}
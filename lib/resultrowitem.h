@@ -0,0 +1,234 @@
+/*
+ * This file is part of the KDE Milou Project
+ * SPDX-FileCopyrightText: 2026 Milou Authors
+ *
+ * SPDX-License-Identifier: LGPL-2.1-only OR LGPL-3.0-only OR LicenseRef-KDE-Accepted-LGPL
+ *
+ */
+
+#pragma once
+
+#include <QColor>
+#include <QFont>
+#include <QIcon>
+#include <QImage>
+#include <QQuickItem>
+#include <QTextLayout>
+
+#include "milou_export.h"
+
+namespace Milou
+{
+/**
+ * A lightweight result row
+ *
+ * Draws category, icon, text and subtext of a match into a few textures
+ * instead of composing them out of a dozen QML items. The text layouts are
+ * kept until text, font or width change, and category and subtext are drawn
+ * separately from the rest, so the row isn't redrawn when only the subtext
+ * changes. Becoming the current row only blends in a highlight.
+ *
+ * The row doesn't handle input and doesn't show any actions,
+ * see ResultRowDelegate.qml for a delegate built around it.
+ */
+class MILOU_EXPORT ResultRowItem : public QQuickItem
+{
+    Q_OBJECT
+
+    /**
+     * The category shown to the left of the row, usually only for the first row of a category
+     */
+    Q_PROPERTY(QString category READ category WRITE setCategory NOTIFY categoryChanged)
+    Q_PROPERTY(QString text READ text WRITE setText NOTIFY textChanged)
+    Q_PROPERTY(QString subtext READ subtext WRITE setSubtext NOTIFY subtextChanged)
+    /**
+     * The icon, either an icon name, an absolute path to an icon or a QIcon
+     */
+    Q_PROPERTY(QVariant icon READ icon WRITE setIcon NOTIFY iconChanged)
+    Q_PROPERTY(int iconSize READ iconSize WRITE setIconSize NOTIFY iconSizeChanged)
+    /**
+     * Width of the area the category is shown in, the icon starts right after it
+     */
+    Q_PROPERTY(int categoryWidth READ categoryWidth WRITE setCategoryWidth NOTIFY categoryWidthChanged)
+    /**
+     * Width kept free on the right, e.g. for the actions of the current row
+     */
+    Q_PROPERTY(qreal reservedWidth READ reservedWidth WRITE setReservedWidth NOTIFY reservedWidthChanged)
+    Q_PROPERTY(int spacing READ spacing WRITE setSpacing NOTIFY spacingChanged)
+    Q_PROPERTY(QFont font READ font WRITE setFont NOTIFY fontChanged)
+    Q_PROPERTY(QColor textColor READ textColor WRITE setTextColor NOTIFY textColorChanged)
+    /**
+     * Color of category and subtext
+     */
+    Q_PROPERTY(QColor secondaryTextColor READ secondaryTextColor WRITE setSecondaryTextColor NOTIFY secondaryTextColorChanged)
+    /**
+     * Whether this is the current row, which makes category and subtext stand out more
+     */
+    Q_PROPERTY(bool current READ isCurrent WRITE setCurrent NOTIFY currentChanged)
+    /**
+     * Whether the text is wrapped rather than elided
+     */
+    Q_PROPERTY(bool multiLine READ isMultiLine WRITE setMultiLine NOTIFY multiLineChanged)
+    /**
+     * Whether to draw a separator line at the top
+     */
+    Q_PROPERTY(bool separatorVisible READ isSeparatorVisible WRITE setSeparatorVisible NOTIFY separatorVisibleChanged)
+    /**
+     * Whether the subtext had to be elided, e.g. to show all of it in a tooltip
+     */
+    Q_PROPERTY(bool subtextTruncated READ isSubtextTruncated NOTIFY subtextTruncatedChanged)
+    /**
+     * Where the subtext is drawn
+     */
+    Q_PROPERTY(QRectF subtextRect READ subtextRect NOTIFY subtextRectChanged)
+
+public:
+    explicit ResultRowItem(QQuickItem *parent = nullptr);
+    ~ResultRowItem() override;
+
+    QString category() const;
+    void setCategory(const QString &category);
+
+    QString text() const;
+    void setText(const QString &text);
+
+    QString subtext() const;
+    void setSubtext(const QString &subtext);
+
+    QVariant icon() const;
+    void setIcon(const QVariant &icon);
+
+    int iconSize() const;
+    void setIconSize(int size);
+
+    int categoryWidth() const;
+    void setCategoryWidth(int width);
+
+    qreal reservedWidth() const;
+    void setReservedWidth(qreal width);
+
+    int spacing() const;
+    void setSpacing(int spacing);
+
+    QFont font() const;
+    void setFont(const QFont &font);
+
+    QColor textColor() const;
+    void setTextColor(const QColor &color);
+
+    QColor secondaryTextColor() const;
+    void setSecondaryTextColor(const QColor &color);
+
+    bool isCurrent() const;
+    void setCurrent(bool current);
+
+    bool isMultiLine() const;
+    void setMultiLine(bool multiLine);
+
+    bool isSeparatorVisible() const;
+    void setSeparatorVisible(bool visible);
+
+    bool isSubtextTruncated() const;
+    QRectF subtextRect() const;
+
+Q_SIGNALS:
+    void categoryChanged();
+    void textChanged();
+    void subtextChanged();
+    void iconChanged();
+    void iconSizeChanged();
+    void categoryWidthChanged();
+    void reservedWidthChanged();
+    void spacingChanged();
+    void fontChanged();
+    void textColorChanged();
+    void secondaryTextColorChanged();
+    void currentChanged();
+    void multiLineChanged();
+    void separatorVisibleChanged();
+    void subtextTruncatedChanged();
+    void subtextRectChanged();
+
+protected:
+    void geometryChanged(const QRectF &newGeometry, const QRectF &oldGeometry) override;
+    void itemChange(ItemChange change, const ItemChangeData &value) override;
+    void updatePolish() override;
+    QSGNode *updatePaintNode(QSGNode *oldNode, UpdatePaintNodeData *data) override;
+
+private:
+    // A text layout that is only redone when its input changed
+    class CachedTextLayout
+    {
+    public:
+        // Returns whether the layout changed
+        bool update(const QString &text, const QFont &font, qreal width, bool wrap);
+        void draw(QPainter *painter, const QPointF &pos) const;
+
+        QSizeF size() const;
+        bool isElided() const;
+
+    private:
+        QString m_text;
+        QFont m_font;
+        qreal m_width = -1;
+        bool m_wrap = false;
+
+        QTextLayout m_layout;
+        QSizeF m_size;
+        bool m_elided = false;
+    };
+
+    enum Layer {
+        RowLayer = 0x1, ///< Separator, icon and text
+        SecondaryLayer = 0x2, ///< Category and subtext, along with their highlight
+        AllLayers = RowLayer | SecondaryLayer,
+    };
+
+    void invalidate(int layers);
+    void paintRow(QPainter *painter);
+    void paintSecondary(QPainter *painter, const QColor &color);
+    QRectF categoryRect() const;
+    // Where category and subtext are drawn, in whole device pixels
+    QRectF secondaryRect() const;
+
+    // Lays out the texts for the current width and updates the implicit height
+    void relayout();
+    qreal textStart() const;
+    qreal devicePixelRatio() const;
+
+    QString m_category;
+    QString m_text;
+    QString m_subtext;
+    QVariant m_icon;
+    int m_iconSize = 22;
+    int m_categoryWidth = 0;
+    qreal m_reservedWidth = 0;
+    int m_spacing = 4;
+    QFont m_font;
+    QColor m_textColor = Qt::black;
+    QColor m_secondaryTextColor = Qt::gray;
+    bool m_current = false;
+    bool m_multiLine = false;
+    bool m_separatorVisible = false;
+    bool m_subtextTruncated = false;
+    QRectF m_subtextRect;
+
+    CachedTextLayout m_categoryLayout;
+    CachedTextLayout m_textLayout;
+    CachedTextLayout m_subtextLayout;
+
+    QImage m_iconImage;
+    bool m_iconDirty = true;
+
+    int m_dirtyLayers = AllLayers;
+    // Layers drawn since they were last uploaded
+    int m_changedLayers = 0;
+    QImage m_image;
+    // Only cover m_secondaryRect, the rest of the row is empty in them
+    QRectF m_secondaryRect;
+    QImage m_secondaryImage;
+    // Category and subtext in the text color, blended over the current row
+    QImage m_highlightImage;
+};
+
+} // namespace Milou
@@ -8,10 +8,20 @@
 
 #include "resultsmodel.h"
 
+#include "latencyhistograms.h"
+#include "pipelinestats.h"
+#include "querydebouncer.h"
+#include "roledatacache.h"
+#include "rowsnapshot.h"
 #include "runnerresultsmodel.h"
+#include "runnerstatsmodel.h"
+#include "stallwatchdog.h"
+#include "tracer.h"
 
 #include <KRunner/RunnerManager>
+#include <QElapsedTimer>
 #include <QIdentityProxyModel>
+#include <QTimer>
 
 #include <KDescendantsProxyModel>
 #include <KModelIndexProxyMapper>
@@ -40,47 +50,71 @@ public:
     }
     ~SortProxyModel() override = default;
 
+    void setSourceModel(QAbstractItemModel *sourceModel) override
+    {
+        if (this->sourceModel()) {
+            disconnect(this->sourceModel(), nullptr, this, nullptr);
+        }
+
+        // Connected before QSortFilterProxyModel so the flags of the categories
+        // are worked out anew by the time it sorts the changed source
+        if (sourceModel) {
+            connect(sourceModel, &QAbstractItemModel::rowsAboutToBeInserted, this, &SortProxyModel::clearCategoryFlags);
+            connect(sourceModel, &QAbstractItemModel::rowsAboutToBeRemoved, this, &SortProxyModel::clearCategoryFlags);
+            connect(sourceModel, &QAbstractItemModel::rowsAboutToBeMoved, this, &SortProxyModel::clearCategoryFlags);
+            connect(sourceModel, &QAbstractItemModel::dataChanged, this, &SortProxyModel::clearCategoryFlags);
+            connect(sourceModel, &QAbstractItemModel::layoutAboutToBeChanged, this, &SortProxyModel::clearCategoryFlags);
+            connect(sourceModel, &QAbstractItemModel::modelAboutToBeReset, this, &SortProxyModel::clearCategoryFlags);
+        }
+
+        clearCategoryFlags();
+        QSortFilterProxyModel::setSourceModel(sourceModel);
+    }
+
     void setQueryString(const QString &queryString)
     {
         const QStringList words = queryString.split(QLatin1Char(' '), Qt::SkipEmptyParts);
         if (m_words != words) {
             m_words = words;
+            clearCategoryFlags();
+            Tracer::Span span("SortProxyModel invalidate", "model");
             invalidate();
         }
     }
 
-    bool categoryHasMatchWithAllWords(const QModelIndex &categoryIdx) const
+    bool isFastLane(const QModelIndex &sourceIdx) const
     {
-        for (int i = 0; i < sourceModel()->rowCount(categoryIdx); ++i) {
-            const QModelIndex idx = sourceModel()->index(i, 0, categoryIdx);
-            const QString display = idx.data(Qt::DisplayRole).toString();
-
-            bool containsAllWords = true;
-            for (const QString &word : m_words) {
-                if (!display.contains(word, Qt::CaseInsensitive)) {
-                    containsAllWords = false;
-                }
-            }
+        return RunnerResultsModel::isFastLaneMatch(sourceIdx.data(ResultsModel::TypeRole).toInt(), sourceIdx.data(ResultsModel::RelevanceRole).toReal());
+    }
 
-            if (containsAllWords) {
-                return true;
+    bool containsAllWords(const QModelIndex &sourceIdx) const
+    {
+        const QString display = sourceIdx.data(Qt::DisplayRole).toString();
+        for (const QString &word : m_words) {
+            if (!display.contains(word, Qt::CaseInsensitive)) {
+                return false;
             }
         }
-
-        return false;
+        return true;
     }
 
 protected:
     bool lessThan(const QModelIndex &sourceA, const QModelIndex &sourceB) const override
     {
-        // prefer categories that have a match containing the query string in the display role
-        if (!sourceA.parent().isValid() && !sourceB.parent().isValid()) {
-            const bool hasMatchWithAllWordsA = categoryHasMatchWithAllWords(sourceA);
-            const bool hasMatchWithAllWordsB = categoryHasMatchWithAllWords(sourceB);
+        // matches the user is waiting for, e.g. calculator results, always go first
+        const bool isCategory = !sourceA.parent().isValid() && !sourceB.parent().isValid();
+        const CategoryFlags flagsA = isCategory ? categoryFlags(sourceA) : CategoryFlags{};
+        const CategoryFlags flagsB = isCategory ? categoryFlags(sourceB) : CategoryFlags{};
+        const bool fastLaneA = isCategory ? flagsA.hasFastLaneMatch : isFastLane(sourceA);
+        const bool fastLaneB = isCategory ? flagsB.hasFastLaneMatch : isFastLane(sourceB);
+
+        if (fastLaneA != fastLaneB) {
+            return !fastLaneA && fastLaneB;
+        }
 
-            if (hasMatchWithAllWordsA != hasMatchWithAllWordsB) {
-                return !hasMatchWithAllWordsA && hasMatchWithAllWordsB;
-            }
+        // prefer categories that have a match containing the query string in the display role
+        if (isCategory && flagsA.hasMatchWithAllWords != flagsB.hasMatchWithAllWords) {
+            return !flagsA.hasMatchWithAllWords && flagsB.hasMatchWithAllWords;
         }
 
         const int typeA = sourceA.data(ResultsModel::TypeRole).toInt();
@@ -90,8 +124,11 @@ protected:
             return typeA < typeB;
         }
 
-        const qreal relevanceA = sourceA.data(ResultsModel::RelevanceRole).toReal();
-        const qreal relevanceB = sourceB.data(ResultsModel::RelevanceRole).toReal();
+        // what the user launched often and recently gets a bit of a boost, but can't outrank much more relevant matches
+        const qreal relevanceA =
+            RunnerResultsModel::boostedRelevance(sourceA.data(ResultsModel::RelevanceRole).toReal(), sourceA.data(ResultsModel::FrecencyRole).toReal());
+        const qreal relevanceB =
+            RunnerResultsModel::boostedRelevance(sourceB.data(ResultsModel::RelevanceRole).toReal(), sourceB.data(ResultsModel::FrecencyRole).toReal());
 
         if (!qFuzzyCompare(relevanceA, relevanceB)) {
             return relevanceA < relevanceB;
@@ -101,7 +138,41 @@ protected:
     }
 
 private:
+    struct CategoryFlags {
+        bool hasFastLaneMatch = false;
+        bool hasMatchWithAllWords = false;
+    };
+
+    // Worked out once per category rather than on every comparison
+    CategoryFlags categoryFlags(const QModelIndex &categoryIdx) const
+    {
+        auto it = m_categoryFlags.constFind(categoryIdx.row());
+        if (it != m_categoryFlags.constEnd()) {
+            return *it;
+        }
+
+        CategoryFlags flags;
+        for (int i = 0; i < sourceModel()->rowCount(categoryIdx); ++i) {
+            const QModelIndex idx = sourceModel()->index(i, 0, categoryIdx);
+            flags.hasFastLaneMatch = flags.hasFastLaneMatch || isFastLane(idx);
+            flags.hasMatchWithAllWords = flags.hasMatchWithAllWords || containsAllWords(idx);
+            if (flags.hasFastLaneMatch && flags.hasMatchWithAllWords) {
+                break;
+            }
+        }
+
+        m_categoryFlags.insert(categoryIdx.row(), flags);
+        return flags;
+    }
+
+    void clearCategoryFlags()
+    {
+        m_categoryFlags.clear();
+    }
+
     QStringList m_words;
+    // By row of the category in the source model
+    mutable QHash<int, CategoryFlags> m_categoryFlags;
 };
 
 /**
@@ -265,6 +336,12 @@ public:
 
     QVariant data(const QModelIndex &index, int role) const override
     {
+        if (role == ResultsModel::RowRole) {
+            RowSnapshot snapshot = QIdentityProxyModel::data(index, role).value<RowSnapshot>();
+            snapshot.isDuplicate = data(index, ResultsModel::DuplicateRole).toBool();
+            return QVariant::fromValue(snapshot);
+        }
+
         if (role != ResultsModel::DuplicateRole) {
             return QIdentityProxyModel::data(index, role);
         }
@@ -286,6 +363,172 @@ public:
     }
 };
 
+/**
+ * Populates the IsFirstInCategoryRole and IsLastInCategoryRole of an item
+ *
+ * The boundaries are worked out once per change of the flat list and kept,
+ * rows whose boundaries changed, e.g. the former last row of a category
+ * that got a new row appended, are announced through dataChanged.
+ */
+class CategoryBoundaryProxyModel : public QIdentityProxyModel
+{
+    Q_OBJECT
+
+public:
+    CategoryBoundaryProxyModel(QObject *parent)
+        : QIdentityProxyModel(parent)
+    {
+    }
+    ~CategoryBoundaryProxyModel() override = default;
+
+    void setSourceModel(QAbstractItemModel *sourceModel) override
+    {
+        if (this->sourceModel()) {
+            disconnect(this->sourceModel(), nullptr, this, nullptr);
+        }
+
+        QIdentityProxyModel::setSourceModel(sourceModel);
+        m_boundaries.clear();
+
+        if (!sourceModel) {
+            return;
+        }
+
+        // Connected after QIdentityProxyModel so that views have processed a change
+        // before we tell them about the rows whose boundaries changed in turn.
+        // Rows are realigned before the change so that new rows are never mistaken for old ones.
+        connect(sourceModel, &QAbstractItemModel::rowsAboutToBeInserted, this, [this](const QModelIndex &parent, int first, int last) {
+            if (!parent.isValid()) {
+                m_boundaries.insert(qMin(first, m_boundaries.count()), last - first + 1, Unknown);
+            }
+        });
+        connect(sourceModel, &QAbstractItemModel::rowsAboutToBeRemoved, this, [this](const QModelIndex &parent, int first, int last) {
+            if (!parent.isValid() && first < m_boundaries.count()) {
+                m_boundaries.remove(first, qMin(last, m_boundaries.count() - 1) - first + 1);
+            }
+        });
+        connect(sourceModel, &QAbstractItemModel::rowsAboutToBeMoved, this, [this] {
+            m_boundaries.clear();
+        });
+        connect(sourceModel, &QAbstractItemModel::layoutAboutToBeChanged, this, [this] {
+            m_boundaries.clear();
+        });
+        connect(sourceModel, &QAbstractItemModel::modelAboutToBeReset, this, [this] {
+            m_boundaries.clear();
+        });
+
+        connect(sourceModel, &QAbstractItemModel::rowsInserted, this, &CategoryBoundaryProxyModel::updateBoundaries);
+        connect(sourceModel, &QAbstractItemModel::rowsRemoved, this, &CategoryBoundaryProxyModel::updateBoundaries);
+        connect(sourceModel, &QAbstractItemModel::rowsMoved, this, &CategoryBoundaryProxyModel::updateAllBoundaries);
+        connect(sourceModel, &QAbstractItemModel::layoutChanged, this, &CategoryBoundaryProxyModel::updateAllBoundaries);
+        connect(sourceModel, &QAbstractItemModel::modelReset, this, &CategoryBoundaryProxyModel::updateBoundaries);
+        connect(sourceModel, &QAbstractItemModel::dataChanged, this, [this](const QModelIndex &, const QModelIndex &, const QVector<int> &roles) {
+            if (roles.isEmpty() || roles.contains(ResultsModel::CategoryRole)) {
+                updateBoundaries();
+            }
+        });
+
+        updateBoundaries();
+    }
+
+    QVariant data(const QModelIndex &index, int role) const override
+    {
+        if (role != ResultsModel::IsFirstInCategoryRole && role != ResultsModel::IsLastInCategoryRole && role != ResultsModel::RowRole) {
+            return QIdentityProxyModel::data(index, role);
+        }
+
+        const int row = index.row();
+        // Rows being inserted are only worked out after views have seen them
+        const quint8 boundaries = row < m_boundaries.count() && m_boundaries.at(row) != Unknown ? m_boundaries.at(row) : computeBoundaries(row);
+
+        if (role == ResultsModel::RowRole) {
+            RowSnapshot snapshot = QIdentityProxyModel::data(index, role).value<RowSnapshot>();
+            snapshot.isFirstInCategory = boundaries & FirstInCategory;
+            snapshot.isLastInCategory = boundaries & LastInCategory;
+            return QVariant::fromValue(snapshot);
+        }
+
+        return role == ResultsModel::IsFirstInCategoryRole ? bool(boundaries & FirstInCategory) : bool(boundaries & LastInCategory);
+    }
+
+private:
+    enum Boundary : quint8 {
+        NoBoundary = 0,
+        FirstInCategory = 1,
+        LastInCategory = 2,
+        Unknown = 0xFF,
+    };
+
+    QString category(int row) const
+    {
+        return sourceModel()->index(row, 0).data(ResultsModel::CategoryRole).toString();
+    }
+
+    quint8 computeBoundaries(int row) const
+    {
+        const int count = sourceModel()->rowCount();
+        if (row < 0 || row >= count) {
+            return NoBoundary;
+        }
+
+        const QString rowCategory = category(row);
+        quint8 boundaries = NoBoundary;
+        if (row == 0 || category(row - 1) != rowCategory) {
+            boundaries |= FirstInCategory;
+        }
+        if (row == count - 1 || category(row + 1) != rowCategory) {
+            boundaries |= LastInCategory;
+        }
+        return boundaries;
+    }
+
+    void updateAllBoundaries()
+    {
+        updateBoundaries();
+        if (rowCount() > 0) {
+            // The rows may have been rearranged in any way, views can't tell which ones changed
+            Q_EMIT dataChanged(index(0, 0),
+                               index(rowCount() - 1, 0),
+                               {ResultsModel::IsFirstInCategoryRole, ResultsModel::IsLastInCategoryRole, ResultsModel::RowRole});
+        }
+    }
+
+    void updateBoundaries()
+    {
+        const int count = sourceModel()->rowCount();
+
+        QStringList categories;
+        categories.reserve(count);
+        for (int i = 0; i < count; ++i) {
+            categories.append(category(i));
+        }
+
+        QVector<quint8> boundaries(count, NoBoundary);
+        for (int i = 0; i < count; ++i) {
+            if (i == 0 || categories.at(i - 1) != categories.at(i)) {
+                boundaries[i] |= FirstInCategory;
+            }
+            if (i == count - 1 || categories.at(i + 1) != categories.at(i)) {
+                boundaries[i] |= LastInCategory;
+            }
+        }
+
+        const QVector<quint8> oldBoundaries = m_boundaries;
+        m_boundaries = boundaries;
+
+        // Only existing rows whose boundaries changed need to be announced
+        const QVector<int> roles{ResultsModel::IsFirstInCategoryRole, ResultsModel::IsLastInCategoryRole, ResultsModel::RowRole};
+        for (int i = 0; i < qMin(count, oldBoundaries.count()); ++i) {
+            if (oldBoundaries.at(i) != Unknown && oldBoundaries.at(i) != boundaries.at(i)) {
+                const QModelIndex idx = index(i, 0);
+                Q_EMIT dataChanged(idx, idx, roles);
+            }
+        }
+    }
+
+    QVector<quint8> m_boundaries;
+};
+
 class Q_DECL_HIDDEN ResultsModel::Private
 {
 public:
@@ -293,14 +536,57 @@ public:
 
     ResultsModel *q;
 
+    void launchPendingQuery();
+    // Emits queryStringChanged if the query string shown changed, pending or launched
+    void notifyQueryString();
+
+    void setActivationPending(bool pending);
+    void checkPendingActivation();
+    void runPendingActivation();
+    // The first result that was found for the current query string, -1 if there is none yet
+    int bestCurrentRow() const;
+
+    // Counts the matches the distribution doesn't show, by runner
+    void updateDiscardedCounts();
+
     QPointer<Plasma::AbstractRunner> runner = nullptr;
 
+    ResultsModel::QueryDebounce queryDebounce = ResultsModel::NoDebounce;
+    QueryDebouncer debouncer;
+    QTimer debounceTimer;
+    QString pendingQueryString;
+    bool hasPendingQueryString = false;
+    QString notifiedQueryString;
+
+    // The top match is considered stable once its relevance reaches this
+    static constexpr qreal s_activationRelevance = 0.85;
+    // Don't wait for a better match for longer than this
+    static constexpr int s_activationDeadline = 250;
+    bool activationPending = false;
+    bool activationScheduled = false;
+    QElapsedTimer activationTimer;
+    QTimer activationDeadlineTimer;
+    bool runningPendingActivation = false;
+
+    // Since the last keystroke, until all runners answered its query
+    QElapsedTimer keystrokeTimer;
+    bool firstResultRecorded = false;
+    LatencyHistograms latencyHistograms;
+
+    QTimer discardedCountsTimer;
+
     RunnerResultsModel *resultsModel;
     SortProxyModel *sortModel;
     CategoryDistributionProxyModel *distributionModel;
     KDescendantsProxyModel *flattenModel;
     HideRootLevelProxyModel *hideRootModel;
     DuplicateDetectorProxyModel *duplicateDetectorModel;
+    CategoryBoundaryProxyModel *boundaryModel;
+
+    // Spares views that read the same row over and over the trip through the proxies
+    RoleDataCache *dataCache;
+
+    PipelineStats *pipelineStats;
 };
 
 ResultsModel::Private::Private(ResultsModel *q)
@@ -311,21 +597,225 @@ ResultsModel::Private::Private(ResultsModel *q)
     , flattenModel(new KDescendantsProxyModel(q))
     , hideRootModel(new HideRootLevelProxyModel(q))
     , duplicateDetectorModel(new DuplicateDetectorProxyModel(q))
+    , boundaryModel(new CategoryBoundaryProxyModel(q))
+    , dataCache(new RoleDataCache(q))
+    , pipelineStats(new PipelineStats(q))
+{
+    // Actions are created on demand and the frecency changes when a match is run,
+    // neither is announced through dataChanged
+    dataCache->setUncachedRoles({ResultsModel::ActionsRole, ResultsModel::FrecencyRole});
+    // Whether a result is a duplicate depends on the text of all the others
+    dataCache->addCrossRowDependency(Qt::DisplayRole, {ResultsModel::DuplicateRole, ResultsModel::RowRole});
+
+    debounceTimer.setSingleShot(true);
+    QObject::connect(&debounceTimer, &QTimer::timeout, q, [this] {
+        launchPendingQuery();
+    });
+
+    activationDeadlineTimer.setSingleShot(true);
+    activationDeadlineTimer.setInterval(s_activationDeadline);
+    QObject::connect(&activationDeadlineTimer, &QTimer::timeout, q, [this] {
+        checkPendingActivation();
+    });
+
+    // Matches arrive in bursts, count once they settled
+    discardedCountsTimer.setSingleShot(true);
+    QObject::connect(&discardedCountsTimer, &QTimer::timeout, q, [this] {
+        updateDiscardedCounts();
+    });
+}
+
+void ResultsModel::Private::setActivationPending(bool pending)
+{
+    if (!pending) {
+        activationDeadlineTimer.stop();
+    }
+    if (activationPending != pending) {
+        activationPending = pending;
+        Q_EMIT q->activationPendingChanged();
+    }
+}
+
+void ResultsModel::Private::checkPendingActivation()
 {
+    if (!activationPending || activationScheduled) {
+        return;
+    }
+
+    const int bestRow = bestCurrentRow();
+    if (bestRow < 0) {
+        // Nothing came up for this query
+        if (!q->querying() && !hasPendingQueryString) {
+            setActivationPending(false);
+            Q_EMIT q->activationFinished(false, int(activationTimer.elapsed()));
+        }
+        return;
+    }
+
+    const QModelIndex bestIdx = q->index(bestRow, 0);
+    const bool stable = bestIdx.data(ResultsModel::TypeRole).toInt() == Plasma::QueryMatch::ExactMatch
+        || bestIdx.data(ResultsModel::RelevanceRole).toReal() >= s_activationRelevance
+        || !activationDeadlineTimer.isActive()
+        || !q->querying();
+
+    if (stable) {
+        // This needs to be delayed as running a result may close the window and clear the query
+        // having us reset the model whilst in the middle of processing the insertion.
+        // The proxy model chain that comes before us really doesn't like this.
+        activationScheduled = true;
+        QTimer::singleShot(0, q, [this] {
+            activationScheduled = false;
+            runPendingActivation();
+        });
+    }
+}
+
+void ResultsModel::Private::runPendingActivation()
+{
+    const int bestRow = bestCurrentRow();
+    if (!activationPending || bestRow < 0) {
+        return;
+    }
+
+    setActivationPending(false);
+    runningPendingActivation = true;
+    const bool success = q->run(q->index(bestRow, 0));
+    runningPendingActivation = false;
+    if (success) {
+        latencyHistograms.record(LatencyHistograms::ActivationToLaunch, activationTimer.elapsed());
+    }
+    Q_EMIT q->activationFinished(success, int(activationTimer.elapsed()));
+}
+
+int ResultsModel::Private::bestCurrentRow() const
+{
+    // The results of the previous query stay until the runners answered the current one,
+    // which may still be held back, they are not what the user asked to run
+    KModelIndexProxyMapper mapper(q, resultsModel);
+    for (int row = 0; row < q->rowCount(); ++row) {
+        if (resultsModel->isCurrentMatch(mapper.mapLeftToRight(q->index(row, 0)))) {
+            return row;
+        }
+    }
+    return -1;
+}
+
+void ResultsModel::Private::updateDiscardedCounts()
+{
+    discardedCountsTimer.stop();
+
+    QHash<QString, int> counts;
+    for (int i = 0; i < sortModel->rowCount(); ++i) {
+        const QModelIndex categoryIdx = sortModel->index(i, 0);
+        const int count = sortModel->rowCount(categoryIdx);
+        // The distribution keeps the first matches of a category
+        const int shown = distributionModel->rowCount(distributionModel->mapFromSource(categoryIdx));
+
+        for (int j = shown; j < count; ++j) {
+            const QString matchKey = sortModel->index(j, 0, categoryIdx).data(ResultsModel::MatchKeyRole).toString();
+            ++counts[matchKey.section(QLatin1Char('/'), 0, 0)];
+        }
+    }
+
+    resultsModel->runnerStats()->setDiscardedCounts(counts);
+}
+
+void ResultsModel::Private::launchPendingQuery()
+{
+    debounceTimer.stop();
+    if (!hasPendingQueryString) {
+        return;
+    }
+    hasPendingQueryString = false;
+    resultsModel->setQueryString(pendingQueryString, q->runner());
+}
+
+void ResultsModel::Private::notifyQueryString()
+{
+    const QString queryString = q->queryString();
+    if (queryString != notifiedQueryString) {
+        notifiedQueryString = queryString;
+        Q_EMIT q->queryStringChanged(queryString);
+    }
 }
 
 ResultsModel::ResultsModel(QObject *parent)
     : QSortFilterProxyModel(parent)
     , d(new Private(this))
 {
-    connect(d->resultsModel, &RunnerResultsModel::queryStringChanged, this, &ResultsModel::queryStringChanged);
+    qRegisterMetaType<Milou::RowSnapshot>();
+
+    connect(d->resultsModel, &RunnerResultsModel::queryStringChanged, this, [this] {
+        d->notifyQueryString();
+    });
     connect(d->resultsModel, &RunnerResultsModel::queryingChanged, this, &ResultsModel::queryingChanged);
     connect(d->resultsModel, &RunnerResultsModel::queryStringChangeRequested, this, &ResultsModel::queryStringChangeRequested);
+    connect(d->resultsModel, &RunnerResultsModel::timeToFirstUsefulResultChanged, this, &ResultsModel::timeToFirstUsefulResultChanged);
+    connect(d->resultsModel, &RunnerResultsModel::skippedQueriesChanged, this, &ResultsModel::skippedQueriesChanged);
+    connect(d->resultsModel, &RunnerResultsModel::routedRunnerChanged, this, &ResultsModel::routedRunnerChanged);
+    connect(d->resultsModel, &RunnerResultsModel::firstMatchesArrived, this, [this](int msecs) {
+        d->debouncer.addRunnerLatency(msecs);
+
+        // Matches of the previous query while the next one is still being debounced don't count
+        if (d->keystrokeTimer.isValid() && !d->firstResultRecorded && !d->hasPendingQueryString) {
+            d->firstResultRecorded = true;
+            d->latencyHistograms.record(LatencyHistograms::KeystrokeToFirstResult, d->keystrokeTimer.elapsed());
+        }
+    });
+    connect(this, &ResultsModel::queryingChanged, this, [this] {
+        if (!querying() && !d->hasPendingQueryString && d->keystrokeTimer.isValid()) {
+            d->latencyHistograms.record(LatencyHistograms::KeystrokeToStable, d->keystrokeTimer.elapsed());
+            d->keystrokeTimer.invalidate();
+        }
+    });
+
+    auto checkPendingActivation = [this] {
+        d->checkPendingActivation();
+    };
+    connect(this, &ResultsModel::rowsInserted, this, checkPendingActivation);
+    connect(this, &ResultsModel::dataChanged, this, checkPendingActivation);
+    connect(this, &ResultsModel::layoutChanged, this, checkPendingActivation);
+    connect(this, &ResultsModel::modelReset, this, checkPendingActivation);
+    connect(this, &ResultsModel::queryingChanged, this, checkPendingActivation);
 
     connect(d->resultsModel, &RunnerResultsModel::queryStringChanged, d->sortModel, &SortProxyModel::setQueryString);
 
     connect(d->distributionModel, &CategoryDistributionProxyModel::limitChanged, this, &ResultsModel::limitChanged);
 
+    // Matches may be dropped by the distribution without it changing, e.g. when a full category gets another one
+    auto scheduleDiscardedCounts = [this] {
+        d->discardedCountsTimer.start();
+    };
+    for (QAbstractItemModel *model : {static_cast<QAbstractItemModel *>(d->sortModel), static_cast<QAbstractItemModel *>(d->distributionModel)}) {
+        connect(model, &QAbstractItemModel::rowsInserted, this, scheduleDiscardedCounts);
+        connect(model, &QAbstractItemModel::rowsRemoved, this, scheduleDiscardedCounts);
+        connect(model, &QAbstractItemModel::layoutChanged, this, scheduleDiscardedCounts);
+        connect(model, &QAbstractItemModel::modelReset, this, scheduleDiscardedCounts);
+    }
+    // The statistics of a query are complete once it finished
+    connect(this, &ResultsModel::queryingChanged, this, [this] {
+        if (!querying()) {
+            d->updateDiscardedCounts();
+            d->resultsModel->runnerStats()->queryFinished();
+        }
+    });
+
+    // Created before the proxies connect to their sources, so that the probes
+    // see the changes of a source before the proxy handles them
+    const QVector<StageProbe *> probes{
+        new StageProbe(d->resultsModel, QByteArrayLiteral("RunnerResultsModel"), d->pipelineStats),
+        new StageProbe(d->sortModel, QByteArrayLiteral("SortProxyModel"), d->pipelineStats, d->resultsModel),
+        new StageProbe(d->distributionModel, QByteArrayLiteral("CategoryDistributionProxyModel"), d->pipelineStats, d->sortModel),
+        new StageProbe(d->flattenModel, QByteArrayLiteral("KDescendantsProxyModel"), d->pipelineStats, d->distributionModel),
+        new StageProbe(d->hideRootModel, QByteArrayLiteral("HideRootLevelProxyModel"), d->pipelineStats, d->flattenModel),
+        new StageProbe(d->duplicateDetectorModel, QByteArrayLiteral("DuplicateDetectorProxyModel"), d->pipelineStats, d->hideRootModel),
+        new StageProbe(d->boundaryModel, QByteArrayLiteral("CategoryBoundaryProxyModel"), d->pipelineStats, d->duplicateDetectorModel),
+        new StageProbe(this, QByteArrayLiteral("ResultsModel"), d->pipelineStats, d->boundaryModel),
+    };
+    d->pipelineStats->setDataCache(d->dataCache);
+    // Each query starts from zero, so the numbers tell which stage made this one slow
+    connect(d->resultsModel, &RunnerResultsModel::queryStringChanged, d->pipelineStats, &PipelineStats::reset);
+
     // The data flows as follows:
     // - RunnerResultsModel
     //   - SortProxyModel
@@ -333,6 +823,7 @@ ResultsModel::ResultsModel(QObject *parent)
     //       - KDescendantsProxyModel
     //         - HideRootLevelProxyModel
     //           - DuplicateDetectorProxyModel
+    //             - CategoryBoundaryProxyModel
 
     d->sortModel->setSourceModel(d->resultsModel);
 
@@ -345,19 +836,87 @@ ResultsModel::ResultsModel(QObject *parent)
 
     d->duplicateDetectorModel->setSourceModel(d->hideRootModel);
 
-    setSourceModel(d->duplicateDetectorModel);
+    d->boundaryModel->setSourceModel(d->duplicateDetectorModel);
+
+    setSourceModel(d->boundaryModel);
+
+    for (StageProbe *probe : probes) {
+        probe->sourceConnected();
+    }
+
+    connect(this, &ResultsModel::queryingChanged, this, [this] {
+        Tracer *tracer = Tracer::instance();
+        if (tracer->isEnabled()) {
+            tracer->instant(querying() ? QByteArrayLiteral("querying") : QByteArrayLiteral("query finished"), "query");
+            if (!querying()) {
+                tracer->flush();
+            }
+        }
+    });
 }
 
 ResultsModel::~ResultsModel() = default;
 
 QString ResultsModel::queryString() const
 {
+    if (d->hasPendingQueryString) {
+        return d->pendingQueryString;
+    }
     return d->resultsModel->queryString();
 }
 
 void ResultsModel::setQueryString(const QString &queryString)
 {
-    d->resultsModel->setQueryString(queryString, runner());
+    Tracer::Span span("setQueryString", "query", {{QStringLiteral("length"), queryString.length()}});
+
+    d->setActivationPending(false);
+
+    // Clearing the query isn't waiting for anything
+    if (queryString.trimmed().isEmpty()) {
+        d->keystrokeTimer.invalidate();
+    } else {
+        d->keystrokeTimer.start();
+        d->firstResultRecorded = false;
+    }
+
+    // Clearing the query should always be instant
+    if (d->queryDebounce == NoDebounce || queryString.trimmed().isEmpty()) {
+        d->hasPendingQueryString = false;
+        d->debounceTimer.stop();
+        d->resultsModel->setQueryString(queryString, runner());
+        // Dropping a pending query string may go back to the one already launched
+        d->notifyQueryString();
+        return;
+    }
+
+    int delay = QueryDebouncer::s_fixedDelay;
+    if (d->queryDebounce == AdaptiveDebounce) {
+        delay = d->debouncer.nextDelay(d->resultsModel->hasMatchOfType(Plasma::QueryMatch::InformationalMatch));
+    }
+
+    d->pendingQueryString = queryString;
+    d->hasPendingQueryString = true;
+    d->debounceTimer.start(delay);
+    // Bindings show what was typed, not what was launched last
+    d->notifyQueryString();
+    Tracer::instance()->instant("debounce", "query", {{QStringLiteral("delay"), delay}});
+}
+
+ResultsModel::QueryDebounce ResultsModel::queryDebounce() const
+{
+    return d->queryDebounce;
+}
+
+void ResultsModel::setQueryDebounce(QueryDebounce queryDebounce)
+{
+    if (d->queryDebounce == queryDebounce) {
+        return;
+    }
+    d->queryDebounce = queryDebounce;
+    if (queryDebounce == NoDebounce) {
+        d->launchPendingQuery();
+    }
+    Q_EMIT queryDebounceChanged();
 }
 
 int ResultsModel::limit() const
@@ -368,6 +927,7 @@ int ResultsModel::limit() const
 void ResultsModel::setLimit(int limit)
 {
     d->distributionModel->setLimit(limit);
+    d->resultsModel->setFillTarget(limit);
 }
 
 void ResultsModel::resetLimit()
@@ -375,11 +935,35 @@ void ResultsModel::resetLimit()
     setLimit(0);
 }
 
+int ResultsModel::expensiveRunnerMinLength() const
+{
+    return d->resultsModel->expensiveRunnerMinLength();
+}
+
+void ResultsModel::setExpensiveRunnerMinLength(int length)
+{
+    if (length == expensiveRunnerMinLength()) {
+        return;
+    }
+    d->resultsModel->setExpensiveRunnerMinLength(length);
+    Q_EMIT expensiveRunnerMinLengthChanged();
+}
+
 bool ResultsModel::querying() const
 {
     return d->resultsModel->querying();
 }
 
+int ResultsModel::timeToFirstUsefulResult() const
+{
+    return d->resultsModel->timeToFirstUsefulResult();
+}
+
+int ResultsModel::skippedQueries() const
+{
+    return d->resultsModel->skippedQueries();
+}
+
 QString ResultsModel::runner() const
 {
     return d->runner ? d->runner->id() : QString();
@@ -408,6 +992,105 @@ QIcon ResultsModel::runnerIcon() const
     return d->runner ? d->runner->icon() : QIcon();
 }
 
+bool ResultsModel::runnerRouting() const
+{
+    return d->resultsModel->runnerRouting();
+}
+
+void ResultsModel::setRunnerRouting(bool routing)
+{
+    if (routing == runnerRouting()) {
+        return;
+    }
+    d->resultsModel->setRunnerRouting(routing);
+    Q_EMIT runnerRoutingChanged();
+}
+
+QString ResultsModel::routedRunner() const
+{
+    return d->resultsModel->routedRunner();
+}
+
+bool ResultsModel::showRecentLaunches() const
+{
+    return d->resultsModel->showRecentLaunches();
+}
+
+void ResultsModel::setShowRecentLaunches(bool show)
+{
+    if (show == showRecentLaunches()) {
+        return;
+    }
+    d->resultsModel->setShowRecentLaunches(show);
+    Q_EMIT showRecentLaunchesChanged();
+}
+
+bool ResultsModel::mergeDuplicates() const
+{
+    return d->resultsModel->mergeDuplicates();
+}
+
+void ResultsModel::setMergeDuplicates(bool merge)
+{
+    if (merge == mergeDuplicates()) {
+        return;
+    }
+
+    d->resultsModel->setMergeDuplicates(merge);
+    Q_EMIT mergeDuplicatesChanged();
+}
+
+PipelineStats *ResultsModel::pipelineStats() const
+{
+    return d->pipelineStats;
+}
+
+QAbstractItemModel *ResultsModel::runnerStats() const
+{
+    return d->resultsModel->runnerStats();
+}
+
+bool ResultsModel::tracing() const
+{
+    return Tracer::instance()->isEnabled();
+}
+
+void ResultsModel::setTracing(bool tracing)
+{
+    Tracer *tracer = Tracer::instance();
+    if (tracer->isEnabled() == tracing) {
+        return;
+    }
+    // Keep what was recorded so far
+    if (!tracing) {
+        tracer->flush();
+    }
+    tracer->setEnabled(tracing);
+    Q_EMIT tracingChanged();
+}
+
+QVariant ResultsModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || index.column() != 0 || !d->dataCache->isCached(role)) {
+        return QSortFilterProxyModel::data(index, role);
+    }
+
+    QVariant value;
+    if (!d->dataCache->lookup(index.row(), role, &value)) {
+        StallWatchdog *watchdog = StallWatchdog::instance();
+        if (watchdog->isEnabled()) {
+            QElapsedTimer timer;
+            timer.start();
+            value = QSortFilterProxyModel::data(index, role);
+            watchdog->addDataTime(timer.nsecsElapsed(), this);
+        } else {
+            value = QSortFilterProxyModel::data(index, role);
+        }
+        d->dataCache->insert(index.row(), role, value);
+    }
+    return value;
+}
+
 QHash<int, QByteArray> ResultsModel::roleNames() const
 {
     auto names = QAbstractItemModel::roleNames();
@@ -420,12 +1103,22 @@ QHash<int, QByteArray> ResultsModel::roleNames() const
     names[DuplicateRole] = QByteArrayLiteral("isDuplicate");
     names[ActionsRole] = QByteArrayLiteral("actions");
     names[MultiLineRole] = QByteArrayLiteral("multiLine");
+    names[FrecencyRole] = QByteArrayLiteral("frecency");
+    names[MatchKeyRole] = QByteArrayLiteral("matchKey");
+    names[IsFirstInCategoryRole] = QByteArrayLiteral("isFirstInCategory");
+    names[IsLastInCategoryRole] = QByteArrayLiteral("isLastInCategory");
+    names[RowRole] = QByteArrayLiteral("row");
     return names;
 }
 
 void ResultsModel::clear()
 {
+    d->setActivationPending(false);
+    d->hasPendingQueryString = false;
+    d->debounceTimer.stop();
+    d->keystrokeTimer.invalidate();
     d->resultsModel->clear();
+    d->notifyQueryString();
 }
 
 bool ResultsModel::run(const QModelIndex &idx)
@@ -435,7 +1128,15 @@ bool ResultsModel::run(const QModelIndex &idx)
     if (!resultsIdx.isValid()) {
         return false;
     }
-    return d->resultsModel->run(resultsIdx);
+
+    QElapsedTimer timer;
+    timer.start();
+    const bool success = d->resultsModel->run(resultsIdx);
+    // A pending activation records the time since it was requested instead
+    if (success && !d->runningPendingActivation) {
+        d->latencyHistograms.record(LatencyHistograms::RunToLaunch, timer.elapsed());
+    }
+    return success;
 }
 
 bool ResultsModel::runAction(const QModelIndex &idx, int actionNumber)
@@ -448,6 +1149,27 @@ bool ResultsModel::runAction(const QModelIndex &idx, int actionNumber)
     return d->resultsModel->runAction(resultsIdx, actionNumber);
 }
 
+void ResultsModel::activateBestMatch()
+{
+    // The user is done typing, no point in waiting any longer
+    d->launchPendingQuery();
+
+    d->activationTimer.start();
+    d->activationDeadlineTimer.start();
+    d->setActivationPending(true);
+    d->checkPendingActivation();
+}
+
+void ResultsModel::cancelActivation()
+{
+    d->setActivationPending(false);
+}
+
+bool ResultsModel::activationPending() const
+{
+    return d->activationPending;
+}
+
 QMimeData *ResultsModel::getMimeData(const QModelIndex &idx) const
 {
     KModelIndexProxyMapper mapper(this, d->resultsModel);
@@ -458,9 +1180,19 @@ QMimeData *ResultsModel::getMimeData(const QModelIndex &idx) const
     return d->resultsModel->mimeData({resultsIdx});
 }
 
+void ResultsModel::traceInstant(const QString &name)
+{
+    Tracer::instance()->instant(name.toUtf8(), "view");
+}
+
 Plasma::RunnerManager *Milou::ResultsModel::runnerManager() const
 {
     return d->resultsModel->runnerManager();
 }
 
+void ResultsModel::addProvider(MatchProvider *provider)
+{
+    d->resultsModel->addProvider(provider);
+}
+
 #include "resultsmodel.moc"
@@ -17,14 +17,29 @@
 
 namespace Milou
 {
+class MatchProvider;
+class PipelineStats;
+
 class MILOU_EXPORT ResultsModel : public QSortFilterProxyModel
 {
     Q_OBJECT
 
     /**
      * The query string to run
+     *
+     * While a query is debounced, this is the query string as typed rather than the one launched.
      */
     Q_PROPERTY(QString queryString READ queryString WRITE setQueryString NOTIFY queryStringChanged)
+    /**
+     * How to delay launching a query after the query string changed
+     *
+     * With debouncing enabled, frontends can set the query string on
+     * every keystroke and leave it to the model when to actually query
+     * the runners.
+     *
+     * Default is NoDebounce, which means the query is launched immediately.
+     */
+    Q_PROPERTY(QueryDebounce queryDebounce READ queryDebounce WRITE setQueryDebounce NOTIFY queryDebounceChanged)
     /**
      * The preferred maximum number of matches in the model
      *
@@ -34,12 +49,44 @@ class MILOU_EXPORT ResultsModel : public QSortFilterProxyModel
      * Default is 0, which means no limit.
      */
     Q_PROPERTY(int limit READ limit WRITE setLimit RESET resetLimit NOTIFY limitChanged)
+    /**
+     * Minimum query length for runners that are known to be slow, e.g. file search
+     *
+     * Shorter queries are only sent to the runners that usually answer quickly.
+     * The slow ones are only asked when the quick ones don't come up with
+     * enough results to fill the @c limit.
+     *
+     * Default is 3
+     */
+    Q_PROPERTY(int expensiveRunnerMinLength READ expensiveRunnerMinLength WRITE setExpensiveRunnerMinLength NOTIFY expensiveRunnerMinLengthChanged)
     /**
      * Whether the query is currently being run
      *
      * This can be used to show a busy indicator
      */
     Q_PROPERTY(bool querying READ querying NOTIFY queryingChanged)
+    /**
+     * Milliseconds it took for the first high-confidence match of the
+     * current query to show up, e.g. a calculator result or an exact
+     * application name
+     *
+     * Such matches are shown as soon as they are found and are always
+     * sorted to the top of the list.
+     *
+     * This is -1 if there is no such match (yet).
+     */
+    Q_PROPERTY(int timeToFirstUsefulResult READ timeToFirstUsefulResult NOTIFY timeToFirstUsefulResultChanged)
+    /**
+     * Number of queries that were skipped because a newer one replaced them
+     * while the runners were still busy with the previous query
+     */
+    Q_PROPERTY(int skippedQueries READ skippedQueries NOTIFY skippedQueriesChanged)
+    /**
+     * Whether the best match will be run as soon as it is known
+     *
+     * @sa activateBestMatch
+     */
+    Q_PROPERTY(bool activationPending READ activationPending NOTIFY activationPendingChanged)
 
     /**
      * The single runner to use for querying in single runner mode
@@ -50,12 +97,85 @@ class MILOU_EXPORT ResultsModel : public QSortFilterProxyModel
     // FIXME rename to singleModeRunnerName or something
     Q_PROPERTY(QString runnerName READ runnerName NOTIFY runnerChanged)
     Q_PROPERTY(QIcon runnerIcon READ runnerIcon NOTIFY runnerChanged)
+    /**
+     * Whether a query that clearly targets a single runner through its syntax,
+     * e.g. "=" for the calculator or a web shortcut, is only sent to that runner
+     *
+     * This has no effect when a runner is set explicitly.
+     *
+     * Default is true
+     */
+    Q_PROPERTY(bool runnerRouting READ runnerRouting WRITE setRunnerRouting NOTIFY runnerRoutingChanged)
+    /**
+     * The runner the current query was sent to exclusively because of its syntax
+     *
+     * Empty when the query went to all runners
+     */
+    Q_PROPERTY(QString routedRunner READ routedRunner NOTIFY routedRunnerChanged)
+    /**
+     * Whether the matches the user launched most frequently and recently
+     * are shown for an empty or one letter query until the runners
+     * come up with something
+     *
+     * Default is true
+     */
+    Q_PROPERTY(bool showRecentLaunches READ showRecentLaunches WRITE setShowRecentLaunches NOTIFY showRecentLaunchesChanged)
+    /**
+     * Whether matches of different runners with the same text and target,
+     * e.g. an application found by both the services and the recent documents
+     * runner, are collapsed into a single result
+     *
+     * The most relevant of them is shown, the actions of the others
+     * are appended to its actions.
+     *
+     * Default is false
+     */
+    Q_PROPERTY(bool mergeDuplicates READ mergeDuplicates WRITE setMergeDuplicates NOTIFY mergeDuplicatesChanged)
+    /**
+     * How quickly and how much each runner answered, for the current query and on average
+     *
+     * A list model with a row per runner, see the role names for what it offers:
+     * time to first and last match, number of matches and how many of them were
+     * not shown because their category exceeded its share of the @c limit.
+     * Times are in milliseconds since the query was launched.
+     */
+    Q_PROPERTY(QAbstractItemModel *runnerStats READ runnerStats CONSTANT)
+    /**
+     * How many rows each stage of the model holds, how often it changed and
+     * how long that took, since the current query was launched
+     */
+    Q_PROPERTY(Milou::PipelineStats *pipelineStats READ pipelineStats CONSTANT)
+    /**
+     * Whether the steps of each query are recorded as a trace, from the query string
+     * changing through the runners and proxy models to the view showing the results
+     *
+     * The trace is written in the Chrome trace event format to the file named by the
+     * MILOU_TRACE_FILE environment variable, which also enables tracing, or to a milou-trace
+     * file in the temporary directory. What was recorded is appended to it whenever a query
+     * finished, when tracing is turned off and at exit. It opens in Perfetto.
+     *
+     * This is shared by all models of the process.
+     *
+     * Default is false, unless MILOU_TRACE_FILE is set
+     */
+    Q_PROPERTY(bool tracing READ tracing WRITE setTracing NOTIFY tracingChanged)
     Q_PROPERTY(Plasma::RunnerManager *runnerManager READ runnerManager CONSTANT)
 
 public:
     explicit ResultsModel(QObject *parent = nullptr);
     ~ResultsModel() override;
 
+    /**
+     * Roles of the results
+     *
+     * A delegate that is reused for another result, e.g. by a ListView with
+     * reuseItems enabled, is rebound by the model: all roles may change on
+     * rebind, except for MatchKeyRole which only changes when the delegate now
+     * shows a different match. Delegates may keep per-match state, like the
+     * selected action, only as long as the match key stays the same.
+     * DuplicateRole depends on the other results, too, delegates should not
+     * carry it over from a previous binding even if the match key is the same.
+     */
     enum Roles {
         IdRole = Qt::UserRole + 1,
         TypeRole,
@@ -66,21 +186,50 @@ public:
         DuplicateRole,
         ActionsRole,
         MultiLineRole,
+        FrecencyRole, ///< How often and how recently the user launched this match
+        MatchKeyRole, ///< Identifies a match across runners and queries, stable as long as the runner reports the same match
+        IsFirstInCategoryRole, ///< Whether the result is the first one of its category
+        IsLastInCategoryRole, ///< Whether the result is the last one of its category
+        RowRole, ///< A RowSnapshot with everything a delegate shows, in a single data() call
     };
     Q_ENUM(Roles)
 
+    enum QueryDebounce {
+        NoDebounce = 0,
+        FixedDebounce, ///< Wait for a fixed 200ms
+        AdaptiveDebounce, ///< Wait depending on the typing cadence and how fast the runners answer
+    };
+    Q_ENUM(QueryDebounce)
+
     QString queryString() const;
     void setQueryString(const QString &queryString);
     Q_SIGNAL void queryStringChanged(const QString &queryString);
 
+    QueryDebounce queryDebounce() const;
+    void setQueryDebounce(QueryDebounce queryDebounce);
+    Q_SIGNAL void queryDebounceChanged();
+
     int limit() const;
     void setLimit(int limit);
     void resetLimit();
     Q_SIGNAL void limitChanged();
 
+    int expensiveRunnerMinLength() const;
+    void setExpensiveRunnerMinLength(int length);
+    Q_SIGNAL void expensiveRunnerMinLengthChanged();
+
     bool querying() const;
     Q_SIGNAL void queryingChanged();
 
+    int timeToFirstUsefulResult() const;
+    Q_SIGNAL void timeToFirstUsefulResultChanged();
+
+    int skippedQueries() const;
+    Q_SIGNAL void skippedQueriesChanged();
+
+    bool activationPending() const;
+    Q_SIGNAL void activationPendingChanged();
+
     QString runner() const;
     void setRunner(const QString &runner);
     Q_SIGNAL void runnerChanged();
@@ -88,6 +237,29 @@ public:
     QString runnerName() const;
     QIcon runnerIcon() const;
 
+    bool runnerRouting() const;
+    void setRunnerRouting(bool routing);
+    Q_SIGNAL void runnerRoutingChanged();
+
+    QString routedRunner() const;
+    Q_SIGNAL void routedRunnerChanged();
+
+    bool showRecentLaunches() const;
+    void setShowRecentLaunches(bool show);
+    Q_SIGNAL void showRecentLaunchesChanged();
+
+    bool mergeDuplicates() const;
+    void setMergeDuplicates(bool merge);
+    Q_SIGNAL void mergeDuplicatesChanged();
+
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    QAbstractItemModel *runnerStats() const;
+    PipelineStats *pipelineStats() const;
+
+    bool tracing() const;
+    void setTracing(bool tracing);
+    Q_SIGNAL void tracingChanged();
+
     QHash<int, QByteArray> roleNames() const override;
 
     /**
@@ -97,6 +269,8 @@ public:
 
     /**
      * Run the result at the given model index @p idx
+     *
+     * Launched results are remembered to rank them higher in the future
      */
     Q_INVOKABLE bool run(const QModelIndex &idx);
     /**
@@ -104,13 +278,46 @@ public:
      */
     Q_INVOKABLE bool runAction(const QModelIndex &idx, int actionNumber);
 
+    /**
+     * Run the best match once it is confidently known
+     *
+     * This is used when the user presses Enter before the results are in.
+     * The top match found for the current query string is run once it is
+     * an exact match, its relevance is high enough, the query finished, or
+     * a short deadline expired. Results still shown from a previous query,
+     * e.g. while the current one is held back, are never run.
+     *
+     * The pending activation is cancelled when the query string changes.
+     *
+     * @sa activationFinished
+     */
+    Q_INVOKABLE void activateBestMatch();
+    /**
+     * Cancel a pending activation requested by activateBestMatch()
+     */
+    Q_INVOKABLE void cancelActivation();
+
     /**
      * Get mime data for the result at given model index @p idx
      */
     Q_INVOKABLE QMimeData *getMimeData(const QModelIndex &idx) const;
 
+    /**
+     * Marks a point in time in the trace, e.g. when the view shows the first result of a query
+     *
+     * Does nothing unless @c tracing is enabled.
+     */
+    Q_INVOKABLE void traceInstant(const QString &name);
+
     Plasma::RunnerManager *runnerManager() const;
 
+    /**
+     * Adds a @p provider whose matches are shown alongside those of the runners
+     *
+     * The model doesn't take ownership of the provider.
+     */
+    void addProvider(MatchProvider *provider);
+
 Q_SIGNALS:
     /**
      * This signal is emitted when a an InformationalMatch is run, and it is advised
@@ -118,6 +325,12 @@ Q_SIGNALS:
      */
     void queryStringChangeRequested(const QString &queryString, int pos);
 
+    /**
+     * This signal is emitted when a pending activation ran the best match,
+     * @p msecs after activateBestMatch() was called
+     */
+    void activationFinished(bool success, int msecs);
+
 private:
     class Private;
     QScopedPointer<Private> d;
@@ -0,0 +1,207 @@
+/*
+ * This file is part of the KDE Milou Project
+ * SPDX-FileCopyrightText: 2026 Milou Authors
+ *
+ * SPDX-License-Identifier: LGPL-2.1-only OR LGPL-3.0-only OR LicenseRef-KDE-Accepted-LGPL
+ *
+ */
+
+#include "roledatacache.h"
+
+#include <QAbstractItemModel>
+
+using namespace Milou;
+
+RoleDataCache::RoleDataCache(QAbstractItemModel *model, int capacity)
+    : QObject(model)
+    , m_model(model)
+    , m_capacity(capacity)
+{
+    connect(model, &QAbstractItemModel::dataChanged, this, [this](const QModelIndex &topLeft, const QModelIndex &bottomRight, const QVector<int> &roles) {
+        if (topLeft.parent().isValid()) {
+            return;
+        }
+        invalidate(topLeft.row(), bottomRight.row(), roles);
+    });
+
+    // Rows in front of the change keep their place
+    connect(model, &QAbstractItemModel::rowsInserted, this, [this](const QModelIndex &parent, int first) {
+        if (!parent.isValid()) {
+            invalidateRowsFrom(first);
+        }
+    });
+    connect(model, &QAbstractItemModel::rowsRemoved, this, [this](const QModelIndex &parent, int first) {
+        if (!parent.isValid()) {
+            invalidateRowsFrom(first);
+        }
+    });
+    connect(model,
+            &QAbstractItemModel::rowsMoved,
+            this,
+            [this](const QModelIndex &sourceParent, int sourceStart, int sourceEnd, const QModelIndex &destinationParent, int destinationRow) {
+                Q_UNUSED(sourceEnd);
+                if (!sourceParent.isValid() || !destinationParent.isValid()) {
+                    invalidateRowsFrom(qMin(sourceStart, destinationRow));
+                }
+            });
+
+    // Views may read rows at their old positions until they're told about the new ones,
+    // so don't let them fill the cache with data of a row that is about to move
+    connect(model, &QAbstractItemModel::layoutAboutToBeChanged, this, &RoleDataCache::clear);
+    connect(model, &QAbstractItemModel::layoutChanged, this, &RoleDataCache::clear);
+    connect(model, &QAbstractItemModel::modelAboutToBeReset, this, &RoleDataCache::clear);
+    connect(model, &QAbstractItemModel::modelReset, this, &RoleDataCache::clear);
+}
+
+RoleDataCache::~RoleDataCache() = default;
+
+void RoleDataCache::setUncachedRoles(const QVector<int> &roles)
+{
+    m_uncachedRoles = QSet<int>(roles.begin(), roles.end());
+    for (int role : roles) {
+        invalidate(0, m_model->rowCount() - 1, {role});
+    }
+}
+
+bool RoleDataCache::isCached(int role) const
+{
+    return !m_uncachedRoles.contains(role);
+}
+
+void RoleDataCache::addCrossRowDependency(int role, const QVector<int> &dependentRoles)
+{
+    m_crossRowDependencies[role] += dependentRoles;
+}
+
+quint64 RoleDataCache::key(int row, int role)
+{
+    return (quint64(quint32(row)) << 32) | quint32(role);
+}
+
+int RoleDataCache::rowOf(quint64 key)
+{
+    return int(quint32(key >> 32));
+}
+
+int RoleDataCache::roleOf(quint64 key)
+{
+    return int(quint32(key));
+}
+
+bool RoleDataCache::lookup(int row, int role, QVariant *value) const
+{
+    auto it = m_data.constFind(key(row, role));
+    if (it == m_data.constEnd()) {
+        ++m_misses;
+        return false;
+    }
+
+    ++m_hits;
+    *value = *it;
+    return true;
+}
+
+void RoleDataCache::insert(int row, int role, const QVariant &value)
+{
+    if (m_uncachedRoles.contains(role)) {
+        return;
+    }
+
+    // Keeping track of the least recently used entries costs more than refilling the cache,
+    // a view only shows a few dozen rows anyway
+    if (m_data.count() >= m_capacity) {
+        m_data.clear();
+    }
+
+    m_data.insert(key(row, role), value);
+}
+
+void RoleDataCache::clear()
+{
+    m_data.clear();
+}
+
+quint64 RoleDataCache::hits() const
+{
+    return m_hits;
+}
+
+quint64 RoleDataCache::misses() const
+{
+    return m_misses;
+}
+
+qreal RoleDataCache::hitRate() const
+{
+    const quint64 lookups = m_hits + m_misses;
+    return lookups > 0 ? qreal(m_hits) / lookups : 0;
+}
+
+int RoleDataCache::count() const
+{
+    return m_data.count();
+}
+
+QVector<int> RoleDataCache::allDependentRoles() const
+{
+    QVector<int> roles;
+    for (const auto &dependent : m_crossRowDependencies) {
+        roles += dependent;
+    }
+    return roles;
+}
+
+void RoleDataCache::invalidateRowsFrom(int row)
+{
+    const QVector<int> dependentRoles = allDependentRoles();
+
+    for (auto it = m_data.begin(); it != m_data.end();) {
+        if (rowOf(it.key()) >= row || dependentRoles.contains(roleOf(it.key()))) {
+            it = m_data.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+void RoleDataCache::invalidate(int first, int last, const QVector<int> &roles)
+{
+    if (m_data.isEmpty()) {
+        return;
+    }
+
+    // No roles means all of them changed
+    if (roles.isEmpty()) {
+        for (auto it = m_data.begin(); it != m_data.end();) {
+            const int row = rowOf(it.key());
+            if (row >= first && row <= last) {
+                it = m_data.erase(it);
+            } else {
+                ++it;
+            }
+        }
+
+        const QVector<int> dependentRoles = allDependentRoles();
+        if (!dependentRoles.isEmpty()) {
+            invalidate(0, m_model->rowCount() - 1, dependentRoles);
+        }
+        return;
+    }
+
+    QSet<int> changedRoles(roles.begin(), roles.end());
+    QSet<int> dependentRoles;
+    for (int role : roles) {
+        const auto dependent = m_crossRowDependencies.value(role);
+        dependentRoles.unite(QSet<int>(dependent.begin(), dependent.end()));
+    }
+
+    for (auto it = m_data.begin(); it != m_data.end();) {
+        const int row = rowOf(it.key());
+        const int role = roleOf(it.key());
+        if ((row >= first && row <= last && changedRoles.contains(role)) || dependentRoles.contains(role)) {
+            it = m_data.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
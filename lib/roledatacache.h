@@ -0,0 +1,92 @@
+/*
+ * This file is part of the KDE Milou Project
+ * SPDX-FileCopyrightText: 2026 Milou Authors
+ *
+ * SPDX-License-Identifier: LGPL-2.1-only OR LGPL-3.0-only OR LicenseRef-KDE-Accepted-LGPL
+ *
+ */
+
+#pragma once
+
+#include <QHash>
+#include <QObject>
+#include <QSet>
+#include <QVariant>
+#include <QVector>
+
+class QAbstractItemModel;
+
+namespace Milou
+{
+/**
+ * Remembers the data of a flat model by row and role
+ *
+ * Views read the same roles of the same rows over and over, e.g. when bindings
+ * are re-evaluated or the current row moves. The cache follows the change signals
+ * of the model it is attached to: rows that are inserted, removed or moved drop
+ * the entries that shifted, changed data drops the changed rows and roles, layout
+ * changes and resets drop everything.
+ *
+ * The model has to look up and fill the cache in its data() and only call
+ * them for column 0 of top-level rows. Entries are only valid while the model
+ * announces every change, roles computed on the fly without change signals
+ * must be excluded with setUncachedRoles().
+ */
+class RoleDataCache : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit RoleDataCache(QAbstractItemModel *model, int capacity = 4096);
+    ~RoleDataCache() override;
+
+    /**
+     * Roles that are never cached
+     */
+    void setUncachedRoles(const QVector<int> &roles);
+    bool isCached(int role) const;
+
+    /**
+     * Roles that depend on other rows, they change without the model announcing it
+     * whenever @p role changes in any row or rows are inserted, removed or moved
+     */
+    void addCrossRowDependency(int role, const QVector<int> &dependentRoles);
+
+    /**
+     * Looks up the data of @p role in @p row, returns whether it was cached
+     */
+    bool lookup(int row, int role, QVariant *value) const;
+    void insert(int row, int role, const QVariant &value);
+
+    void clear();
+
+    quint64 hits() const;
+    quint64 misses() const;
+    /**
+     * Fraction of lookups that were answered from the cache, 0 if there were none
+     */
+    qreal hitRate() const;
+    int count() const;
+
+private:
+    static quint64 key(int row, int role);
+    static int rowOf(quint64 key);
+    static int roleOf(quint64 key);
+
+    QVector<int> allDependentRoles() const;
+    void invalidateRowsFrom(int row);
+    void invalidate(int first, int last, const QVector<int> &roles);
+
+    QAbstractItemModel *m_model;
+    int m_capacity;
+
+    QSet<int> m_uncachedRoles;
+    QHash<int /*role*/, QVector<int> /*dependent roles*/> m_crossRowDependencies;
+
+    QHash<quint64 /*row, role*/, QVariant> m_data;
+
+    mutable quint64 m_hits = 0;
+    mutable quint64 m_misses = 0;
+};
+
+} // namespace Milou
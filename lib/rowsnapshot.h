@@ -0,0 +1,74 @@
+/*
+ * This file is part of the KDE Milou Project
+ * SPDX-FileCopyrightText: 2026 Milou Authors
+ *
+ * SPDX-License-Identifier: LGPL-2.1-only OR LGPL-3.0-only OR LicenseRef-KDE-Accepted-LGPL
+ *
+ */
+
+#pragma once
+
+#include <QMetaType>
+#include <QString>
+#include <QVariant>
+
+#include "milou_export.h"
+
+namespace Milou
+{
+/**
+ * Everything a delegate shows of a result, fetched at once through ResultsModel::RowRole
+ *
+ * The version changes whenever the match changes, the fields contributed
+ * by the proxy models (isDuplicate, isFirstInCategory, isLastInCategory)
+ * can change independently of it.
+ */
+class MILOU_EXPORT RowSnapshot
+{
+    Q_GADGET
+
+    Q_PROPERTY(QString text MEMBER text)
+    Q_PROPERTY(QString subtext MEMBER subtext)
+    Q_PROPERTY(QVariant icon MEMBER icon)
+    Q_PROPERTY(QString category MEMBER category)
+    Q_PROPERTY(QString matchKey MEMBER matchKey)
+    Q_PROPERTY(int type MEMBER type)
+    Q_PROPERTY(qreal relevance MEMBER relevance)
+    Q_PROPERTY(bool enabled MEMBER enabled)
+    Q_PROPERTY(bool multiLine MEMBER multiLine)
+    Q_PROPERTY(bool isDuplicate MEMBER isDuplicate)
+    Q_PROPERTY(bool isFirstInCategory MEMBER isFirstInCategory)
+    Q_PROPERTY(bool isLastInCategory MEMBER isLastInCategory)
+    Q_PROPERTY(quint64 version MEMBER version)
+
+public:
+    QString text;
+    QString subtext;
+    QVariant icon;
+    QString category;
+    QString matchKey;
+    int type = 0;
+    qreal relevance = 0;
+    bool enabled = true;
+    bool multiLine = false;
+
+    bool isDuplicate = false;
+    bool isFirstInCategory = false;
+    bool isLastInCategory = false;
+
+    quint64 version = 0;
+
+    bool operator==(const RowSnapshot &other) const
+    {
+        return version == other.version && isDuplicate == other.isDuplicate && isFirstInCategory == other.isFirstInCategory
+            && isLastInCategory == other.isLastInCategory;
+    }
+    bool operator!=(const RowSnapshot &other) const
+    {
+        return !(*this == other);
+    }
+};
+
+} // namespace Milou
+
+Q_DECLARE_METATYPE(Milou::RowSnapshot)
@@ -8,12 +8,32 @@
 
 #include "runnerresultsmodel.h"
 
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
 #include <QAction>
+#include <QCoreApplication>
+#include <QEvent>
+#include <QIcon>
+#include <QPair>
 #include <QSet>
 
+#include <KLocalizedString>
+#include <KRunner/AbstractRunner>
+#include <KRunner/RunnerContext>
 #include <KRunner/RunnerManager>
+#include <KRunner/RunnerSyntax>
 
+#include "frecencyprovider.h"
+#include "frecencystore.h"
+#include "lazymimedata.h"
+#include "matchprovider.h"
+#include "queryresultcache.h"
 #include "resultsmodel.h"
+#include "runnerstatsmodel.h"
+#include "stallwatchdog.h"
+#include "tracer.h"
 
 using namespace Milou;
 using namespace Plasma;
@@ -21,13 +41,43 @@ using namespace Plasma;
 RunnerResultsModel::RunnerResultsModel(QObject *parent)
     : QAbstractItemModel(parent)
     , m_manager(new RunnerManager(QStringLiteral("krunnerrc"), this))
+    , m_frecency(new FrecencyStore)
+    , m_cache(new QueryResultCache)
+    , m_runnerStats(new RunnerStatsModel(this))
 {
+    // Make sure the cache makes it to disk at the end of the session
+    connect(qApp, &QCoreApplication::aboutToQuit, this, [this] {
+        m_cache->save();
+    });
+
+    addProvider(new FrecencyProvider(m_frecency.data(), m_manager, this));
+
     m_manager->enableKNotifyPluginWatcher();
+    m_manager->installEventFilter(this);
     connect(m_manager, &RunnerManager::matchesChanged, this, &RunnerResultsModel::onMatchesChanged);
     connect(m_manager, &RunnerManager::queryFinished, this, [this] {
-        setQuerying(false);
+        if (m_hasPendingQuery) {
+            launchPendingQuery();
+        } else if (!m_heldBackRunners.isEmpty() && matchCount() < qMax(1, m_fillTarget)) {
+            // The cheap runners couldn't fill the list, ask the expensive ones after all
+            escalateQuery();
+        } else {
+            // Provisional matches are replaced by the first matches the runners come up with,
+            // if they found nothing at all, don't keep showing what they didn't confirm
+            if (m_showingProvisionalMatches) {
+                m_showingProvisionalMatches = false;
+                m_runnerMatches.clear();
+                applyMatches();
+            } else if (m_launchedRunner.isEmpty()) {
+                cacheMatches();
+            }
+            setQuerying(false);
+        }
     });
     connect(m_manager, &RunnerManager::setSearchTerm, this, &RunnerResultsModel::queryStringChangeRequested);
+    // The RunnerManager coalesces match updates, listen to the context directly
+    // so high-confidence matches can skip the queue
+    connect(m_manager->searchContext(), &RunnerContext::matchesChanged, this, &RunnerResultsModel::onContextMatchesChanged, Qt::QueuedConnection);
 
     m_resetTimer.setSingleShot(true);
     m_resetTimer.setInterval(500);
@@ -40,11 +90,19 @@ RunnerResultsModel::RunnerResultsModel(QObject *parent)
             m_categories.clear();
             m_matches.clear();
             endResetModel();
+            m_runnerMatches.clear();
         }
     });
+
+    // Don't hold back the latest query for too long if the runners are busy for a while
+    m_pendingQueryTimer.setSingleShot(true);
+    connect(&m_pendingQueryTimer, &QTimer::timeout, this, &RunnerResultsModel::launchPendingQuery);
 }
 
-RunnerResultsModel::~RunnerResultsModel() = default;
+RunnerResultsModel::~RunnerResultsModel()
+{
+    m_cache->save();
+}
 
 Plasma::QueryMatch RunnerResultsModel::fetchMatch(const QModelIndex &idx) const
 {
@@ -52,13 +110,117 @@ Plasma::QueryMatch RunnerResultsModel::fetchMatch(const QModelIndex &idx) const
     return m_matches.value(category).value(idx.row());
 }
 
+bool RunnerResultsModel::isFastLaneMatch(int type, qreal relevance)
+{
+    return type == Plasma::QueryMatch::ExactMatch || type == Plasma::QueryMatch::InformationalMatch || relevance >= 1.0;
+}
+
+qreal RunnerResultsModel::boostedRelevance(qreal relevance, qreal frecency)
+{
+    // Every launch closes half of the remaining gap, a match the user never launched isn't boosted
+    return relevance + s_maxFrecencyBoost * (1.0 - std::pow(0.5, qMax<qreal>(0.0, frecency)));
+}
+
+void RunnerResultsModel::onContextMatchesChanged()
+{
+    if (!m_querying) {
+        return;
+    }
+
+    const QList<Plasma::QueryMatch> contextMatches = m_manager->searchContext()->matches();
+
+    QList<Plasma::QueryMatch> matches;
+    QSet<QString> newFastLaneIds;
+    for (const auto &match : contextMatches) {
+        if (isFastLaneMatch(match.type(), match.relevance()) && !m_fastLaneIds.contains(match.id())) {
+            m_fastLaneIds.insert(match.id());
+            newFastLaneIds.insert(match.id());
+            matches.append(match);
+        }
+    }
+
+    if (matches.isEmpty()) {
+        return;
+    }
+
+    // Only the new fast lane matches skip the queue, they join what is shown already,
+    // everything else arrives through the RunnerManager's matchesChanged in due time
+    for (const auto &match : qAsConst(m_runnerMatches)) {
+        if (!newFastLaneIds.contains(match.id())) {
+            matches.append(match);
+        }
+    }
+
+    showRunnerMatches(matches, m_escalatedMatches + contextMatches);
+}
+
 void RunnerResultsModel::onMatchesChanged(const QList<Plasma::QueryMatch> &matches)
 {
+    // After escalating a query the RunnerManager only knows what the held back runners found
+    const QList<Plasma::QueryMatch> queryMatches = m_escalatedMatches + matches;
+    showRunnerMatches(queryMatches, queryMatches);
+}
+
+void RunnerResultsModel::showRunnerMatches(const QList<Plasma::QueryMatch> &matches, const QList<Plasma::QueryMatch> &queryMatches)
+{
+    Tracer::Span span("matchesChanged", "query", {{QStringLiteral("matches"), matches.count()}});
+    StallWatchdog::Scope stallScope("matchesChanged", this);
+
+    // The query in flight delivered, the runners are responsive again
+    m_launchedQueryMatchIds.clear();
+    for (const auto &match : queryMatches) {
+        m_launchedQueryMatchIds.insert(match.id());
+    }
+
+    if (!queryMatches.isEmpty()) {
+        m_launchedQueryDelivered = true;
+        if (m_hasPendingQuery) {
+            m_pendingQueryTimer.start(0);
+        }
+    }
+
+    // Keep showing recent launches or cached results until the runners come up with something
+    if (m_showingProvisionalMatches) {
+        if (matches.isEmpty()) {
+            return;
+        }
+        m_showingProvisionalMatches = false;
+    }
+
     // We clear the model ourselves in the reset timer, ignore any empty matchset
     if (matches.isEmpty() && m_resetTimer.isActive() && !m_hasMatches) {
         return;
     }
 
+    if (m_launchTimer.isValid()) {
+        const int elapsed = int(m_launchTimer.elapsed());
+
+        if (!queryMatches.isEmpty() && !m_firstMatchesArrived) {
+            m_firstMatchesArrived = true;
+            Q_EMIT firstMatchesArrived(elapsed);
+        }
+
+        m_runnerStats->matchesChanged(queryMatches, elapsed);
+    }
+
+    if (m_timeToFirstUsefulResult < 0 && m_queryTimer.isValid()) {
+        for (const auto &match : queryMatches) {
+            if (isFastLaneMatch(match.type(), match.relevance())) {
+                m_timeToFirstUsefulResult = int(m_queryTimer.elapsed());
+                Q_EMIT timeToFirstUsefulResultChanged();
+                break;
+            }
+        }
+    }
+
+    m_runnerMatches = matches;
+    applyMatches();
+}
+
+void RunnerResultsModel::applyMatches()
+{
+    Tracer::Span span("applyMatches", "model");
+
     // Build the list of new categories and matches
     QSet<QString> newCategories;
     // here we use QString as key since at this point we don't care about the order
@@ -66,11 +228,46 @@ void RunnerResultsModel::onMatchesChanged(const QList<Plasma::QueryMatch> &match
     // Below when we populate the actual m_matches we'll make sure to keep the order
     // of existing categories to avoid pointless model changes.
     QHash<QString /*category*/, QVector<Plasma::QueryMatch>> newMatches;
-    for (const auto &match : matches) {
+
+    QVector<Plasma::QueryMatch> allMatches;
+    if (m_showingProvisionalMatches) {
+        // They already contain what the providers know
+        allMatches = m_provisionalMatches;
+    } else {
+        allMatches.reserve(m_runnerMatches.count() + m_providerMatches.count());
+        QSet<QString> runnerMatchIds;
+        for (const auto &match : qAsConst(m_runnerMatches)) {
+            allMatches.append(match);
+            runnerMatchIds.insert(match.id());
+        }
+
+        // Merge in what the providers came up with, unless a runner has a fresher version of it
+        for (const auto &match : qAsConst(m_providerMatches)) {
+            if (!runnerMatchIds.contains(match.id())) {
+                allMatches.append(match);
+            }
+        }
+        m_provisionalMatches.clear();
+    }
+
+    m_alternateMatches.clear();
+    if (m_mergeDuplicates) {
+        allMatches = mergeDuplicates(allMatches);
+    }
+
+    // Only the matches that weren't shown before need to be looked up
+    QHash<QString, qreal> frecencyScores;
+    frecencyScores.reserve(allMatches.count());
+    for (const auto &match : qAsConst(allMatches)) {
+        const QString key = StoredMatch::key(match);
+        const auto scoreIt = m_frecencyScores.constFind(key);
+        frecencyScores.insert(key, scoreIt != m_frecencyScores.constEnd() ? *scoreIt : m_frecency->score(key));
+
         const QString category = match.matchCategory();
         newCategories.insert(category);
         newMatches[category].append(match);
     }
+    m_frecencyScores = frecencyScores;
 
     // Get rid of all categories that are no longer present
     auto it = m_categories.begin();
@@ -159,9 +356,137 @@ void RunnerResultsModel::onMatchesChanged(const QList<Plasma::QueryMatch> &match
 
     Q_ASSERT(m_categories.count() == m_matches.count());
 
+    // Snapshots of matches that are long gone
+    if (m_rowSnapshots.count() > 4 * qMax(1, matchCount())) {
+        m_rowSnapshots.clear();
+    }
+
     m_hasMatches = !m_matches.isEmpty();
 }
 
+QString RunnerResultsModel::duplicateKey(const Plasma::QueryMatch &match)
+{
+    QString target;
+    const auto urls = match.urls();
+    if (!urls.isEmpty()) {
+        for (const QUrl &url : urls) {
+            target += url.toString() + QLatin1Char(' ');
+        }
+    } else {
+        target = match.data().toString();
+    }
+
+    // Without knowing where a match leads we can't tell whether it's the same
+    if (target.isEmpty()) {
+        return QString();
+    }
+    return match.text() + QLatin1Char('\n') + target;
+}
+
+QVector<Plasma::QueryMatch> RunnerResultsModel::mergeDuplicates(const QVector<Plasma::QueryMatch> &matches)
+{
+    QVector<Plasma::QueryMatch> merged;
+    merged.reserve(matches.count());
+    QHash<QString /*duplicateKey*/, int /*index in merged*/> representatives;
+
+    for (const auto &match : matches) {
+        const QString key = duplicateKey(match);
+        if (key.isEmpty()) {
+            merged.append(match);
+            continue;
+        }
+
+        auto it = representatives.constFind(key);
+        if (it == representatives.constEnd()) {
+            representatives.insert(key, merged.count());
+            merged.append(match);
+            continue;
+        }
+
+        // Keep the more relevant one in the list, the other one only contributes its actions
+        Plasma::QueryMatch &representative = merged[*it];
+        if (match.relevance() > representative.relevance()) {
+            auto alternates = m_alternateMatches.take(representative.id());
+            alternates.prepend(representative);
+            representative = match;
+            m_alternateMatches.insert(representative.id(), alternates);
+        } else {
+            m_alternateMatches[representative.id()].append(match);
+        }
+    }
+
+    return merged;
+}
+
+QVector<QPair<Plasma::QueryMatch, QAction *>> RunnerResultsModel::matchActions(const Plasma::QueryMatch &match) const
+{
+    QVector<QPair<Plasma::QueryMatch, QAction *>> actions;
+
+    const auto ownActions = m_manager->actionsForMatch(match);
+    for (QAction *action : ownActions) {
+        actions.append(qMakePair(match, action));
+    }
+
+    const auto alternates = m_alternateMatches.value(match.id());
+    for (const auto &alternate : alternates) {
+        const auto alternateActions = m_manager->actionsForMatch(alternate);
+        for (QAction *action : alternateActions) {
+            // Runners may share actions between their matches
+            if (!ownActions.contains(action)) {
+                actions.append(qMakePair(alternate, action));
+            }
+        }
+    }
+
+    return actions;
+}
+
+// Whether a delegate would show both the same
+static bool sameShownFields(const RowSnapshot &a, const RowSnapshot &b)
+{
+    if (a.text != b.text || a.subtext != b.subtext || a.category != b.category || a.type != b.type || a.enabled != b.enabled
+        || a.multiLine != b.multiLine) {
+        return false;
+    }
+
+    // QIcons only compare by identity, their cache key tells whether they're copies
+    if (a.icon.userType() == qMetaTypeId<QIcon>() && b.icon.userType() == qMetaTypeId<QIcon>()) {
+        return a.icon.value<QIcon>().cacheKey() == b.icon.value<QIcon>().cacheKey();
+    }
+    return a.icon == b.icon;
+}
+
+RowSnapshot RunnerResultsModel::rowSnapshot(const Plasma::QueryMatch &match) const
+{
+    const QString key = StoredMatch::key(match);
+
+    RowSnapshot snapshot;
+    snapshot.text = match.text();
+    snapshot.subtext = match.subtext();
+    if (!match.iconName().isEmpty()) {
+        snapshot.icon = match.iconName();
+    } else {
+        snapshot.icon = match.icon();
+    }
+    snapshot.category = match.matchCategory();
+    snapshot.matchKey = key;
+    snapshot.type = match.type();
+    snapshot.relevance = match.relevance();
+    snapshot.enabled = match.isEnabled();
+    snapshot.multiLine = match.isMultiLine();
+
+    // Runners hand out new matches for every query, keep the version while the row looks the same
+    auto it = m_rowSnapshots.find(key);
+    if (it != m_rowSnapshots.end() && sameShownFields(*it, snapshot)) {
+        snapshot.version = it->version;
+    } else {
+        snapshot.version = ++m_rowSnapshotVersion;
+    }
+
+    m_rowSnapshots.insert(key, snapshot);
+    return snapshot;
+}
+
 QString RunnerResultsModel::queryString() const
 {
     return m_queryString;
@@ -169,29 +494,544 @@ QString RunnerResultsModel::queryString() const
 
 void RunnerResultsModel::setQueryString(const QString &queryString, const QString &runner)
 {
-    // If our query and runner are the same we don't need to query again
-    if (m_queryString.trimmed() == queryString.trimmed() && m_prevRunner == runner) {
+    // If our query and runner are the same we don't need to query again,
+    // unless the recent launches for the empty query haven't been shown yet
+    if (m_queryString.trimmed() == queryString.trimmed() && m_prevRunner == runner && (!queryString.isEmpty() || m_hasMatches)) {
         return;
     }
 
     m_prevRunner = runner;
     m_queryString = queryString;
     m_hasMatches = false;
+    m_fastLaneIds.clear();
+    m_queryTimer.invalidate();
+    if (m_timeToFirstUsefulResult != -1) {
+        m_timeToFirstUsefulResult = -1;
+        Q_EMIT timeToFirstUsefulResultChanged();
+    }
+
+    QString routedRunner;
     if (queryString.isEmpty()) {
         clear();
+        if (m_showRecentLaunches) {
+            showRecentLaunches(QString());
+        }
     } else if (!queryString.trimmed().isEmpty()) {
-        m_resetTimer.start();
-        m_manager->launchQuery(queryString, runner);
-        setQuerying(true);
+        if (runner.isEmpty() && m_runnerRouting) {
+            routedRunner = routeQuery(queryString);
+        }
+
+        m_queryTimer.start();
+        scheduleQuery(queryString, routedRunner.isEmpty() ? runner : routedRunner);
+
+        // Providers are for general queries, not when the user asked for a specific runner
+        if (runner.isEmpty() && routedRunner.isEmpty()) {
+            queryProviders(queryString);
+
+            // Cached results already contain what the providers know,
+            // their matches are merged in once the runners answer
+            if (!showCachedMatches(queryString)) {
+                if (m_showRecentLaunches && queryString.trimmed().size() == 1) {
+                    showRecentLaunches(queryString.trimmed());
+                } else if (!m_providerMatches.isEmpty()) {
+                    m_showingProvisionalMatches = false;
+                    applyMatches();
+                }
+            }
+        } else {
+            m_providerMatches.clear();
+            m_providerMatchOwners.clear();
+        }
+    }
+
+    if (m_routedRunner != routedRunner) {
+        m_routedRunner = routedRunner;
+        Q_EMIT routedRunnerChanged();
     }
+
     Q_EMIT queryStringChanged(queryString);
 }
 
+void RunnerResultsModel::addProvider(MatchProvider *provider)
+{
+    m_providers.append(provider);
+    connect(provider, &MatchProvider::matchesChanged, this, [this] {
+        if (m_queryString.trimmed().isEmpty()) {
+            return;
+        }
+        queryProviders(m_queryString);
+        if (!m_showingProvisionalMatches) {
+            applyMatches();
+        }
+    });
+    connect(provider, &QObject::destroyed, this, [this, provider] {
+        m_providers.removeOne(provider);
+    });
+}
+
+void RunnerResultsModel::queryProviders(const QString &queryString)
+{
+    m_providerMatches.clear();
+    m_providerMatchOwners.clear();
+
+    for (MatchProvider *provider : qAsConst(m_providers)) {
+        const int firstMatch = m_providerMatches.count();
+        // Providers add their matches straight to our storage
+        provider->match(queryString, m_providerMatches);
+
+        for (int i = firstMatch; i < m_providerMatches.count(); ++i) {
+            m_providerMatchOwners.insert(m_providerMatches.at(i).id(), provider);
+        }
+    }
+}
+
+void RunnerResultsModel::showRecentLaunches(const QString &query)
+{
+    const QString category = i18nc("@title:group", "Recently Used");
+
+    const auto recentMatches = m_frecency->recentMatches(query, s_recentLaunchesLimit);
+
+    QVector<Plasma::QueryMatch> matches;
+    matches.reserve(recentMatches.count());
+    for (const StoredMatch &recentMatch : recentMatches) {
+        Plasma::QueryMatch match = recentMatch.toQueryMatch(m_manager);
+        if (match.isValid()) {
+            match.setMatchCategory(category);
+            matches.append(match);
+        }
+    }
+
+    showProvisionalMatches(matches);
+}
+
+bool RunnerResultsModel::showCachedMatches(const QString &query)
+{
+    const auto cachedMatches = m_cache->matches(query);
+
+    QVector<Plasma::QueryMatch> matches;
+    matches.reserve(cachedMatches.count());
+    for (const StoredMatch &cachedMatch : cachedMatches) {
+        const Plasma::QueryMatch match = cachedMatch.toQueryMatch(m_manager);
+        if (match.isValid()) {
+            matches.append(match);
+        }
+    }
+
+    return showProvisionalMatches(matches);
+}
+
+bool RunnerResultsModel::showProvisionalMatches(const QVector<Plasma::QueryMatch> &matches)
+{
+    if (matches.isEmpty()) {
+        return false;
+    }
+
+    // Swapped in like any other matches, so rows that stay aren't recreated
+    m_provisionalMatches = matches;
+    m_runnerMatches.clear();
+    m_showingProvisionalMatches = true;
+    applyMatches();
+    return true;
+}
+
+void RunnerResultsModel::cacheMatches()
+{
+    QVector<Plasma::QueryMatch> matches;
+    for (const auto &categoryMatches : qAsConst(m_matches)) {
+        matches += categoryMatches;
+    }
+
+    if (matches.isEmpty()) {
+        return;
+    }
+
+    std::sort(matches.begin(), matches.end(), [](const Plasma::QueryMatch &a, const Plasma::QueryMatch &b) {
+        if (a.type() != b.type()) {
+            return a.type() > b.type();
+        }
+        return a.relevance() > b.relevance();
+    });
+
+    QVector<StoredMatch> storedMatches;
+    storedMatches.reserve(qMin(matches.count(), int(QueryResultCache::s_maxMatchesPerQuery)));
+    for (const Plasma::QueryMatch &match : qAsConst(matches)) {
+        if (storedMatches.count() == QueryResultCache::s_maxMatchesPerQuery) {
+            break;
+        }
+        // Running a match that lost its data could make its runner misbehave
+        if (StoredMatch::isStorable(match)) {
+            storedMatches.append(StoredMatch::fromQueryMatch(match));
+        }
+    }
+
+    m_cache->insert(m_launchedQuery, storedMatches);
+    recordQueryUse();
+}
+
+void RunnerResultsModel::recordQueryUse()
+{
+    // Once per query, whether it finished or a result was run from it first
+    if (m_launchedQueryUseRecorded || !m_launchedRunner.isEmpty()) {
+        return;
+    }
+    m_launchedQueryUseRecorded = true;
+    m_cache->recordUse(m_launchedQuery);
+}
+
+bool RunnerResultsModel::mergeDuplicates() const
+{
+    return m_mergeDuplicates;
+}
+
+void RunnerResultsModel::setMergeDuplicates(bool merge)
+{
+    if (m_mergeDuplicates == merge) {
+        return;
+    }
+
+    m_mergeDuplicates = merge;
+    if (!m_showingProvisionalMatches) {
+        applyMatches();
+    }
+}
+
+bool RunnerResultsModel::showRecentLaunches() const
+{
+    return m_showRecentLaunches;
+}
+
+void RunnerResultsModel::setShowRecentLaunches(bool show)
+{
+    m_showRecentLaunches = show;
+}
+
+bool RunnerResultsModel::eventFilter(QObject *watched, QEvent *event)
+{
+    // The runners are children of the manager, which loads them lazily and again when the configuration changes
+    if (watched == m_manager && (event->type() == QEvent::ChildAdded || event->type() == QEvent::ChildRemoved)) {
+        m_triggersDirty = true;
+    }
+    return QAbstractItemModel::eventFilter(watched, event);
+}
+
+void RunnerResultsModel::invalidateTriggers()
+{
+    m_triggersDirty = true;
+}
+
+void RunnerResultsModel::updateTriggers()
+{
+    if (!m_triggersDirty) {
+        return;
+    }
+    m_triggersDirty = false;
+
+    const QList<AbstractRunner *> runners = m_manager->runners();
+
+    QHash<QString /*prefix*/, QString /*runnerId*/> runnerForPrefix;
+    QSet<QString> ambiguousPrefixes;
+
+    for (AbstractRunner *runner : runners) {
+        // Runners may update their syntaxes when they prepare for a session, e.g. after the user changed a keyword
+        connect(runner, &AbstractRunner::prepare, this, &RunnerResultsModel::invalidateTriggers, Qt::UniqueConnection);
+
+        const auto syntaxes = runner->syntaxes();
+        for (const RunnerSyntax &syntax : syntaxes) {
+            const auto exampleQueries = syntax.exampleQueries();
+            for (const QString &exampleQuery : exampleQueries) {
+                // Only syntaxes that start with a fixed word or symbol can be routed,
+                // not those starting with the search term, like unit conversion does
+                const int termPos = exampleQuery.indexOf(QLatin1String(":q:"));
+                if (termPos <= 0) {
+                    continue;
+                }
+
+                const QString prefix = exampleQuery.left(termPos).toLower();
+                if (prefix.trimmed().isEmpty()) {
+                    continue;
+                }
+
+                const QString existingRunnerId = runnerForPrefix.value(prefix);
+                if (!existingRunnerId.isEmpty() && existingRunnerId != runner->id()) {
+                    ambiguousPrefixes.insert(prefix);
+                }
+                runnerForPrefix.insert(prefix, runner->id());
+            }
+        }
+    }
+
+    m_triggers.clear();
+    for (auto it = runnerForPrefix.constBegin(); it != runnerForPrefix.constEnd(); ++it) {
+        if (!ambiguousPrefixes.contains(it.key())) {
+            m_triggers.append(RunnerTrigger{it.key(), it.value()});
+        }
+    }
+
+    std::sort(m_triggers.begin(), m_triggers.end(), [](const RunnerTrigger &a, const RunnerTrigger &b) {
+        return a.prefix.size() > b.prefix.size();
+    });
+}
+
+QString RunnerResultsModel::routeQuery(const QString &queryString)
+{
+    updateTriggers();
+
+    for (const RunnerTrigger &trigger : qAsConst(m_triggers)) {
+        // There needs to be something to search for after the prefix
+        if (queryString.size() <= trigger.prefix.size() || !queryString.startsWith(trigger.prefix, Qt::CaseInsensitive)) {
+            continue;
+        }
+
+        // "define" is a trigger, "definitely" isn't
+        if (trigger.prefix.back().isLetterOrNumber() && queryString.at(trigger.prefix.size()).isLetterOrNumber()) {
+            continue;
+        }
+
+        return trigger.runnerId;
+    }
+
+    return QString();
+}
+
+bool RunnerResultsModel::runnerRouting() const
+{
+    return m_runnerRouting;
+}
+
+void RunnerResultsModel::setRunnerRouting(bool routing)
+{
+    m_runnerRouting = routing;
+}
+
+QString RunnerResultsModel::routedRunner() const
+{
+    return m_routedRunner;
+}
+
+void RunnerResultsModel::scheduleQuery(const QString &queryString, const QString &runner)
+{
+    // Launching a query doesn't stop the runners working on the previous one,
+    // so while they haven't come up with anything hold back new queries
+    // and only launch the latest one once they're done
+    if (m_querying && !m_launchedQueryDelivered) {
+        if (m_hasPendingQuery) {
+            ++m_skippedQueries;
+            Q_EMIT skippedQueriesChanged();
+        } else {
+            m_pendingQueryTimer.start(s_maxPendingQueryDelay);
+        }
+
+        m_pendingQuery = queryString;
+        m_pendingRunner = runner;
+        m_hasPendingQuery = true;
+        return;
+    }
+
+    launchQuery(queryString, runner);
+}
+
+void RunnerResultsModel::launchPendingQuery()
+{
+    if (!m_hasPendingQuery) {
+        return;
+    }
+
+    m_pendingQueryTimer.stop();
+    m_hasPendingQuery = false;
+    launchQuery(m_pendingQuery, m_pendingRunner);
+}
+
+void RunnerResultsModel::launchQuery(const QString &queryString, const QString &runner)
+{
+    Tracer::Span span("launchQuery", "query", {{QStringLiteral("runner"), runner}});
+    StallWatchdog::instance()->setQueryLength(queryString.length());
+
+    m_hasMatches = false;
+    m_launchedQueryDelivered = false;
+    m_launchedQueryMatchIds.clear();
+    m_fastLaneIds.clear();
+    m_resetTimer.start();
+    m_launchTimer.start();
+    m_firstMatchesArrived = false;
+    m_runnerStats->queryLaunched();
+
+    // Expensive runners usually don't have anything useful to say about very short queries
+    m_escalatedMatches.clear();
+    m_heldBackRunners.clear();
+    if (runner.isEmpty() && queryString.trimmed().size() < m_expensiveRunnerMinLength) {
+        m_heldBackRunners = runnersToHoldBack(queryString);
+    }
+
+    m_launchedQuery = queryString;
+    m_launchedRunner = runner;
+    m_launchedQueryUseRecorded = false;
+    if (m_heldBackRunners.isEmpty()) {
+        m_manager->launchQuery(queryString, runner);
+    } else {
+        launchQueryWithout(queryString, m_heldBackRunners);
+    }
+    setQuerying(true);
+}
+
+void RunnerResultsModel::escalateQuery()
+{
+    // Only the held back runners are asked, what the others found for the query stays
+    m_escalatedMatches.clear();
+    for (const auto &match : qAsConst(m_runnerMatches)) {
+        if (m_launchedQueryMatchIds.contains(match.id())) {
+            m_escalatedMatches.append(match);
+        }
+    }
+
+    QSet<QString> answeredRunners;
+    const auto runners = m_manager->runners();
+    for (AbstractRunner *runner : runners) {
+        if (!m_heldBackRunners.contains(runner->id())) {
+            answeredRunners.insert(runner->id());
+        }
+    }
+    m_heldBackRunners.clear();
+
+    // The held back runners' latency counts from when they were asked
+    m_launchTimer.start();
+
+    // The RunnerManager ignores launching the query it is already running
+    m_manager->reset();
+    launchQueryWithout(m_launchedQuery, answeredRunners);
+    setQuerying(true);
+}
+
+QSet<QString> RunnerResultsModel::runnersToHoldBack(const QString &queryString) const
+{
+    const int length = queryString.trimmed().size();
+
+    QSet<QString> heldBackRunners;
+    bool hasCheapRunner = false;
+
+    const auto runners = m_manager->runners();
+    for (AbstractRunner *runner : runners) {
+        // Those aren't asked for a query this short anyway
+        if (runner->minLetterCount() > length) {
+            continue;
+        }
+
+        // Runners that never answered may well be expensive, they are asked once the cheap ones didn't come up with enough
+        if (runnerCost(runner->id()) == CheapRunner) {
+            hasCheapRunner = true;
+        } else {
+            heldBackRunners.insert(runner->id());
+        }
+    }
+
+    // Without any runner known to be cheap, e.g. with a fresh profile, all of them
+    // are asked, which is how their cost is learned
+    if (!hasCheapRunner) {
+        return {};
+    }
+    return heldBackRunners;
+}
+
+void RunnerResultsModel::launchQueryWithout(const QString &queryString, const QSet<QString> &runnerIds)
+{
+    // The RunnerManager only lets us query either one or all runners. It skips the runners
+    // that need a longer query while launching it though, so raising the length they need
+    // just for the launch leaves them out without anyone else using the runners noticing
+    QVector<QPair<AbstractRunner *, int>> minLetterCounts;
+    for (const QString &runnerId : runnerIds) {
+        if (AbstractRunner *runner = m_manager->runner(runnerId)) {
+            minLetterCounts.append(qMakePair(runner, runner->minLetterCount()));
+            runner->setMinLetterCount(std::numeric_limits<int>::max());
+        }
+    }
+
+    m_manager->launchQuery(queryString);
+
+    for (const auto &minLetterCount : qAsConst(minLetterCounts)) {
+        minLetterCount.first->setMinLetterCount(minLetterCount.second);
+    }
+}
+
+RunnerResultsModel::RunnerCost RunnerResultsModel::runnerCost(const QString &runnerId) const
+{
+    const qreal latency = m_runnerStats->averageFirstMatchTime(runnerId);
+    if (latency < 0) {
+        return UnknownCost;
+    }
+    return latency > s_expensiveRunnerLatency ? ExpensiveRunner : CheapRunner;
+}
+
+RunnerStatsModel *RunnerResultsModel::runnerStats() const
+{
+    return m_runnerStats;
+}
+
+int RunnerResultsModel::expensiveRunnerMinLength() const
+{
+    return m_expensiveRunnerMinLength;
+}
+
+void RunnerResultsModel::setExpensiveRunnerMinLength(int length)
+{
+    m_expensiveRunnerMinLength = length;
+}
+
+void RunnerResultsModel::setFillTarget(int count)
+{
+    m_fillTarget = count;
+}
+
+int RunnerResultsModel::matchCount() const
+{
+    int count = 0;
+    for (const auto &matches : m_matches) {
+        count += matches.count();
+    }
+    return count;
+}
+
+bool RunnerResultsModel::isCurrentMatch(const QModelIndex &idx) const
+{
+    if (!idx.isValid() || !idx.internalId()) {
+        return false;
+    }
+
+    // Recent launches and cached results are only shown for the current query string,
+    // so are the matches of the providers, which are asked right away
+    const QString id = fetchMatch(idx).id();
+    if (m_showingProvisionalMatches || m_providerMatchOwners.contains(id)) {
+        return true;
+    }
+
+    return m_launchedQuery.trimmed() == m_queryString.trimmed() && m_launchedQueryMatchIds.contains(id);
+}
+
+bool RunnerResultsModel::hasMatchOfType(Plasma::QueryMatch::Type type) const
+{
+    for (const auto &matches : m_matches) {
+        for (const auto &match : matches) {
+            if (match.type() == type) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+int RunnerResultsModel::skippedQueries() const
+{
+    return m_skippedQueries;
+}
+
 bool RunnerResultsModel::querying() const
 {
     return m_querying;
 }
 
+int RunnerResultsModel::timeToFirstUsefulResult() const
+{
+    return m_timeToFirstUsefulResult;
+}
+
 void RunnerResultsModel::setQuerying(bool querying)
 {
     if (m_querying != querying) {
@@ -202,6 +1042,13 @@ void RunnerResultsModel::setQuerying(bool querying)
 
 void RunnerResultsModel::clear()
 {
+    m_launchTimer.invalidate();
+    m_runnerStats->clear();
+    m_heldBackRunners.clear();
+    m_escalatedMatches.clear();
+    m_pendingQueryTimer.stop();
+    m_hasPendingQuery = false;
+
     m_manager->reset();
     m_manager->matchSessionComplete();
 
@@ -212,14 +1059,33 @@ void RunnerResultsModel::clear()
     m_matches.clear();
     endResetModel();
 
+    m_runnerMatches.clear();
+    m_launchedQueryMatchIds.clear();
+    m_providerMatches.clear();
+    m_providerMatchOwners.clear();
+    m_alternateMatches.clear();
+    m_rowSnapshots.clear();
+    m_frecencyScores.clear();
+    m_provisionalMatches.clear();
     m_hasMatches = false;
+    m_showingProvisionalMatches = false;
 }
 
 bool RunnerResultsModel::run(const QModelIndex &idx)
 {
     Plasma::QueryMatch match = fetchMatch(idx);
-    if (match.isValid() && match.isEnabled()) {
-        return m_manager->runMatch(match);
+    if (!match.isEnabled()) {
+        return false;
+    }
+
+    if (!match.runner()) {
+        MatchProvider *provider = m_providerMatchOwners.value(match.id());
+        return provider && provider->run(match);
+    }
+
+    if (match.isValid() && m_manager->runMatch(match)) {
+        recordLaunch(match);
+        return true;
     }
     return false;
 }
@@ -231,13 +1097,32 @@ bool RunnerResultsModel::runAction(const QModelIndex &idx, int actionNumber)
         return false;
     }
 
-    const auto actions = m_manager->actionsForMatch(match);
+    const auto actions = matchActions(match);
     if (actionNumber < 0 || actionNumber >= actions.count()) {
         return false;
     }
 
-    match.setSelectedAction(actions.at(actionNumber));
-    return m_manager->runMatch(match);
+    // The action may belong to a duplicate that was merged into this match
+    match = actions.at(actionNumber).first;
+    match.setSelectedAction(actions.at(actionNumber).second);
+    if (m_manager->runMatch(match)) {
+        recordLaunch(match);
+        return true;
+    }
+    return false;
+}
+
+void RunnerResultsModel::recordLaunch(const Plasma::QueryMatch &match)
+{
+    m_frecency->recordLaunch(match);
+    if (!m_launchedQuery.isEmpty()) {
+        recordQueryUse();
+    }
+
+    const QString key = StoredMatch::key(match);
+    if (m_frecencyScores.contains(key)) {
+        m_frecencyScores.insert(key, m_frecency->score(key));
+    }
 }
 
 int RunnerResultsModel::columnCount(const QModelIndex &parent) const
@@ -276,7 +1161,8 @@ QVariant RunnerResultsModel::data(const QModelIndex &index, int role) const
         }
 
         Plasma::QueryMatch match = fetchMatch(index);
-        if (!match.isValid()) {
+        // Matches of providers don't necessarily have a runner
+        if (!match.isValid() && !m_providerMatchOwners.contains(match.id())) {
             return QVariant();
         }
 
@@ -302,8 +1188,14 @@ QVariant RunnerResultsModel::data(const QModelIndex &index, int role) const
             return match.subtext();
         case ResultsModel::MultiLineRole:
             return match.isMultiLine();
+        case ResultsModel::FrecencyRole:
+            return m_frecencyScores.value(StoredMatch::key(match));
+        case ResultsModel::MatchKeyRole:
+            return StoredMatch::key(match);
+        case ResultsModel::RowRole:
+            return QVariant::fromValue(rowSnapshot(match));
         case ResultsModel::ActionsRole: {
-            const auto actions = m_manager->actionsForMatch(match);
+            const auto actions = matchActions(match);
             if (actions.isEmpty()) {
                 return QVariantList();
             }
@@ -311,8 +1203,8 @@ QVariant RunnerResultsModel::data(const QModelIndex &index, int role) const
             QVariantList actionsList;
             actionsList.reserve(actions.size());
 
-            for (QAction *action : actions) {
-                actionsList.append(QVariant::fromValue(action));
+            for (const auto &action : actions) {
+                actionsList.append(QVariant::fromValue(action.second));
             }
 
             return actionsList;
@@ -352,6 +1244,16 @@ QVariant RunnerResultsModel::data(const QModelIndex &index, int role) const
         }
         return highestRelevance;
     }
+    case ResultsModel::FrecencyRole: {
+        qreal highestFrecency = 0.0;
+        for (int i = 0; i < rowCount(index); ++i) {
+            const qreal frecency = this->index(i, 0, index).data(ResultsModel::FrecencyRole).toReal();
+            if (frecency > highestFrecency) {
+                highestFrecency = frecency;
+            }
+        }
+        return highestFrecency;
+    }
     }
 
     return QVariant();
@@ -400,7 +1302,11 @@ QMimeData *RunnerResultsModel::mimeData(const QModelIndexList &indexes) const
         return nullptr;
     }
 
-    return m_manager->mimeDataForMatch(match);
+    // Only matches with urls are known to have something to drag without asking the runner
+    if (match.urls().isEmpty()) {
+        return m_manager->mimeDataForMatch(match);
+    }
+    return new LazyMimeData(match, m_manager);
 }
 
 Plasma::RunnerManager *RunnerResultsModel::runnerManager() const
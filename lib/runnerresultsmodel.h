@@ -9,12 +9,20 @@
 #pragma once
 
 #include <QAbstractItemModel>
+#include <QElapsedTimer>
 #include <QHash>
+#include <QPair>
+#include <QScopedPointer>
+#include <QSet>
 #include <QString>
 #include <QTimer>
 
 #include <KRunner/QueryMatch>
 
+#include "rowsnapshot.h"
+
+class QAction;
+
 namespace Plasma
 {
 class RunnerManager;
@@ -22,6 +30,11 @@ class RunnerManager;
 
 namespace Milou
 {
+class FrecencyStore;
+class MatchProvider;
+class QueryResultCache;
+class RunnerStatsModel;
+
 class RunnerResultsModel : public QAbstractItemModel
 {
     Q_OBJECT
@@ -37,6 +50,117 @@ public:
     bool querying() const;
     Q_SIGNAL void queryingChanged();
 
+    /**
+     * Milliseconds between launching the current query and the first
+     * fast lane match showing up in the model, -1 if there is none yet
+     */
+    int timeToFirstUsefulResult() const;
+    Q_SIGNAL void timeToFirstUsefulResultChanged();
+
+    /**
+     * Whether a match is one the user is most likely waiting for, e.g. a
+     * calculator result or an exact application name
+     *
+     * Such matches bypass the match coalescing of the RunnerManager and
+     * are sorted to the top of the list.
+     */
+    static bool isFastLaneMatch(int type, qreal relevance);
+
+    /**
+     * The relevance a match is sorted by, its @p relevance raised by at most
+     * s_maxFrecencyBoost the more often and recently the user launched it
+     */
+    static qreal boostedRelevance(qreal relevance, qreal frecency);
+
+    /**
+     * Whether queries that clearly target a single runner, e.g. using its
+     * prefix like "=" for the calculator, should only be sent to that runner
+     */
+    bool runnerRouting() const;
+    void setRunnerRouting(bool routing);
+
+    /**
+     * The runner the current query was sent to exclusively because
+     * of its syntax, empty if the query went to all runners
+     */
+    QString routedRunner() const;
+    Q_SIGNAL void routedRunnerChanged();
+
+    enum RunnerCost {
+        UnknownCost,
+        CheapRunner,
+        ExpensiveRunner,
+    };
+
+    /**
+     * How expensive querying a runner is, learned from how long it took to answer previous queries
+     */
+    RunnerCost runnerCost(const QString &runnerId) const;
+
+    /**
+     * How quickly and how much each runner answered the current and the previous queries
+     */
+    RunnerStatsModel *runnerStats() const;
+
+    /**
+     * Minimum query length for expensive runners to be queried
+     *
+     * Shorter queries only go to cheap runners, unless those don't come up with enough matches,
+     * then only the runners that were held back are asked. Runners whose cost isn't known
+     * yet are held back, too, unless no runner is known to be cheap.
+     */
+    int expensiveRunnerMinLength() const;
+    void setExpensiveRunnerMinLength(int length);
+
+    /**
+     * Number of matches the cheap runners need to come up with for a
+     * short query before the expensive ones are asked, too
+     */
+    void setFillTarget(int count);
+
+    /**
+     * Whether the most frequently and recently launched matches are shown
+     * for an empty or one letter query until the runners come up with something
+     */
+    bool showRecentLaunches() const;
+    void setShowRecentLaunches(bool show);
+
+    /**
+     * Whether matches of different runners with the same text and target are merged
+     *
+     * Only the most relevant of them is kept, the actions of the others are
+     * appended to its actions.
+     */
+    bool mergeDuplicates() const;
+    void setMergeDuplicates(bool merge);
+
+    /**
+     * Adds a provider whose matches are merged with those of the runners
+     *
+     * The provider is queried synchronously whenever the query string changes.
+     */
+    void addProvider(MatchProvider *provider);
+
+    /**
+     * Whether the match at @p idx was found for the current query string
+     *
+     * The matches of the previous query are shown until the runners
+     * come up with something for the current one.
+     */
+    bool isCurrentMatch(const QModelIndex &idx) const;
+
+    /**
+     * Whether any of the current matches is of the given @p type
+     */
+    bool hasMatchOfType(Plasma::QueryMatch::Type type) const;
+
+    /**
+     * Number of queries that were never launched because a newer
+     * query replaced them while the runners were still busy
+     */
+    int skippedQueries() const;
+    Q_SIGNAL void skippedQueriesChanged();
+
     /**
      * Clears the model content and resets the runner context, i.e. no new items will appear.
      */
@@ -57,26 +181,131 @@ public:
 
     Plasma::RunnerManager *runnerManager() const;
 
+protected:
+    bool eventFilter(QObject *watched, QEvent *event) override;
+
 Q_SIGNALS:
     void queryStringChangeRequested(const QString &queryString, int pos);
+    /**
+     * Emitted when the first matches for a launched query arrived @p msecs after launching it
+     */
+    void firstMatchesArrived(int msecs);
 
 private:
     void setQuerying(bool querying);
 
+    void scheduleQuery(const QString &queryString, const QString &runner);
+    void launchPendingQuery();
+    void launchQuery(const QString &queryString, const QString &runner);
+
+    void escalateQuery();
+    QSet<QString> runnersToHoldBack(const QString &queryString) const;
+    void launchQueryWithout(const QString &queryString, const QSet<QString> &runnerIds);
+    int matchCount() const;
+
+    void showRecentLaunches(const QString &query);
+    bool showCachedMatches(const QString &query);
+    // Shows matches until the runners come up with the real ones
+    bool showProvisionalMatches(const QVector<Plasma::QueryMatch> &matches);
+    void cacheMatches();
+    void recordQueryUse();
+    void recordLaunch(const Plasma::QueryMatch &match);
+
+    // Rebuilds the triggers if runners were loaded or updated since they were last built
+    void updateTriggers();
+    void invalidateTriggers();
+    QString routeQuery(const QString &queryString);
+
     Plasma::QueryMatch fetchMatch(const QModelIndex &idx) const;
 
     void onMatchesChanged(const QList<Plasma::QueryMatch> &matches);
+    // Shows @p matches, @p queryMatches are all the runners found for the current query so far
+    void showRunnerMatches(const QList<Plasma::QueryMatch> &matches, const QList<Plasma::QueryMatch> &queryMatches);
+    // Merges the matches of runners and providers into the model
+    void applyMatches();
+    static QString duplicateKey(const Plasma::QueryMatch &match);
+    QVector<Plasma::QueryMatch> mergeDuplicates(const QVector<Plasma::QueryMatch> &matches);
+    RowSnapshot rowSnapshot(const Plasma::QueryMatch &match) const;
+    // The actions of a match and those of its merged duplicates, along with the match they belong to
+    QVector<QPair<Plasma::QueryMatch, QAction *>> matchActions(const Plasma::QueryMatch &match) const;
+    void queryProviders(const QString &queryString);
+    void onContextMatchesChanged();
 
     Plasma::RunnerManager *m_manager;
+    QScopedPointer<FrecencyStore> m_frecency;
+    QScopedPointer<QueryResultCache> m_cache;
+    RunnerStatsModel *m_runnerStats;
+
+    static constexpr int s_recentLaunchesLimit = 5;
+    static constexpr qreal s_maxFrecencyBoost = 0.2;
+    // Looked up once when a match arrives and updated when it is run
+    QHash<QString /*matchKey*/, qreal> m_frecencyScores;
+    bool m_showRecentLaunches = true;
+    bool m_showingProvisionalMatches = false;
+    // Recent launches or cached results shown until the runners answer
+    QVector<Plasma::QueryMatch> m_provisionalMatches;
 
     QString m_queryString;
     bool m_querying = false;
 
     QString m_prevRunner;
 
+    struct RunnerTrigger {
+        QString prefix;
+        QString runnerId;
+    };
+    bool m_runnerRouting = true;
+    QString m_routedRunner;
+    // Longest prefix first
+    QVector<RunnerTrigger> m_triggers;
+    bool m_triggersDirty = true;
+
     QTimer m_resetTimer;
     bool m_hasMatches = false;
 
+    QElapsedTimer m_queryTimer;
+    QElapsedTimer m_launchTimer;
+    bool m_firstMatchesArrived = false;
+    int m_timeToFirstUsefulResult = -1;
+    QSet<QString> m_fastLaneIds;
+
+    // At most one query is in flight, the latest one typed meanwhile waits here
+    static constexpr int s_maxPendingQueryDelay = 200;
+    QTimer m_pendingQueryTimer;
+    QString m_pendingQuery;
+    QString m_pendingRunner;
+    bool m_hasPendingQuery = false;
+    // Whether the runners came up with anything for the query in flight
+    bool m_launchedQueryDelivered = false;
+    // What the runners found for the query in flight so far
+    QSet<QString> m_launchedQueryMatchIds;
+    int m_skippedQueries = 0;
+
+    // Runners answering slower than this on average are considered expensive
+    static constexpr int s_expensiveRunnerLatency = 150;
+    int m_expensiveRunnerMinLength = 3;
+    int m_fillTarget = 0;
+    QString m_launchedQuery;
+    QString m_launchedRunner;
+    bool m_launchedQueryUseRecorded = false;
+    QSet<QString /*runnerId*/> m_heldBackRunners;
+    // What the other runners found before the held back ones were asked
+    QList<Plasma::QueryMatch> m_escalatedMatches;
+
+    QList<Plasma::QueryMatch> m_runnerMatches;
+
+    QVector<MatchProvider *> m_providers;
+    QVector<Plasma::QueryMatch> m_providerMatches;
+    QHash<QString /*matchId*/, MatchProvider *> m_providerMatchOwners;
+
+    bool m_mergeDuplicates = false;
+    // The matches merged into the one with the given id
+    QHash<QString /*matchId*/, QVector<Plasma::QueryMatch>> m_alternateMatches;
+
+    // The last snapshot of every match, for their versions
+    mutable QHash<QString /*matchKey*/, RowSnapshot> m_rowSnapshots;
+    mutable quint64 m_rowSnapshotVersion = 0;
+
     QStringList m_categories;
     QHash<QString /*category*/, QVector<Plasma::QueryMatch>> m_matches;
 };
@@ -0,0 +1,205 @@
+/*
+ * This file is part of the KDE Milou Project
+ * SPDX-FileCopyrightText: 2026 Milou Authors
+ *
+ * SPDX-License-Identifier: LGPL-2.1-only OR LGPL-3.0-only OR LicenseRef-KDE-Accepted-LGPL
+ *
+ */
+
+#include "runnerstatsmodel.h"
+
+#include <KRunner/AbstractRunner>
+
+using namespace Milou;
+
+RunnerStatsModel::RunnerStatsModel(QObject *parent)
+    : QAbstractListModel(parent)
+{
+}
+
+RunnerStatsModel::~RunnerStatsModel() = default;
+
+int RunnerStatsModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : m_stats.count();
+}
+
+QVariant RunnerStatsModel::data(const QModelIndex &index, int role) const
+{
+    if (!checkIndex(index, CheckIndexOption::IndexIsValid | CheckIndexOption::ParentIsInvalid)) {
+        return QVariant();
+    }
+
+    const RunnerStats &stats = m_stats.at(index.row());
+
+    switch (role) {
+    case Qt::DisplayRole:
+        return stats.name;
+    case RunnerIdRole:
+        return stats.runnerId;
+    case FirstMatchTimeRole:
+        return stats.firstMatchTime;
+    case LastMatchTimeRole:
+        return stats.lastMatchTime;
+    case MatchCountRole:
+        return stats.matchCount;
+    case DiscardedCountRole:
+        return stats.discardedCount;
+    case AverageFirstMatchTimeRole:
+        return stats.averageFirstMatchTime.value();
+    case AverageLastMatchTimeRole:
+        return stats.averageLastMatchTime.value();
+    case AverageMatchCountRole:
+        return stats.averageMatchCount.value();
+    case AverageDiscardedCountRole:
+        return stats.averageDiscardedCount.value();
+    case QueryCountRole:
+        return stats.queryCount;
+    }
+
+    return QVariant();
+}
+
+QHash<int, QByteArray> RunnerStatsModel::roleNames() const
+{
+    return {
+        {Qt::DisplayRole, QByteArrayLiteral("display")},
+        {RunnerIdRole, QByteArrayLiteral("runnerId")},
+        {FirstMatchTimeRole, QByteArrayLiteral("firstMatchTime")},
+        {LastMatchTimeRole, QByteArrayLiteral("lastMatchTime")},
+        {MatchCountRole, QByteArrayLiteral("matchCount")},
+        {DiscardedCountRole, QByteArrayLiteral("discardedCount")},
+        {AverageFirstMatchTimeRole, QByteArrayLiteral("averageFirstMatchTime")},
+        {AverageLastMatchTimeRole, QByteArrayLiteral("averageLastMatchTime")},
+        {AverageMatchCountRole, QByteArrayLiteral("averageMatchCount")},
+        {AverageDiscardedCountRole, QByteArrayLiteral("averageDiscardedCount")},
+        {QueryCountRole, QByteArrayLiteral("queryCount")},
+    };
+}
+
+int RunnerStatsModel::rowFor(const QString &runnerId, const QString &name)
+{
+    const auto it = m_rows.constFind(runnerId);
+    if (it != m_rows.constEnd()) {
+        return *it;
+    }
+
+    const int row = m_stats.count();
+    beginInsertRows(QModelIndex(), row, row);
+    RunnerStats stats;
+    stats.runnerId = runnerId;
+    stats.name = name;
+    m_stats.append(stats);
+    m_rows.insert(runnerId, row);
+    endInsertRows();
+
+    return row;
+}
+
+void RunnerStatsModel::emitRowChanged(int row)
+{
+    const QModelIndex idx = index(row, 0);
+    Q_EMIT dataChanged(idx, idx);
+}
+
+void RunnerStatsModel::resetCurrentQuery()
+{
+    for (int i = 0; i < m_stats.count(); ++i) {
+        RunnerStats &stats = m_stats[i];
+        if (stats.firstMatchTime != -1 || stats.matchCount != 0 || stats.discardedCount != 0) {
+            stats.firstMatchTime = -1;
+            stats.lastMatchTime = -1;
+            stats.matchCount = 0;
+            stats.discardedCount = 0;
+            emitRowChanged(i);
+        }
+    }
+}
+
+void RunnerStatsModel::queryLaunched()
+{
+    resetCurrentQuery();
+    m_queryRunning = true;
+}
+
+void RunnerStatsModel::matchesChanged(const QList<Plasma::QueryMatch> &matches, int msecs)
+{
+    if (!m_queryRunning) {
+        return;
+    }
+
+    // The runner manager always hands out all matches of the query so far
+    QHash<const Plasma::AbstractRunner *, int> counts;
+    for (const auto &match : matches) {
+        if (const Plasma::AbstractRunner *runner = match.runner()) {
+            ++counts[runner];
+        }
+    }
+
+    for (auto it = counts.constBegin(); it != counts.constEnd(); ++it) {
+        const int row = rowFor(it.key()->id(), it.key()->name());
+        RunnerStats &stats = m_stats[row];
+
+        if (stats.matchCount == *it) {
+            continue;
+        }
+
+        if (stats.firstMatchTime < 0) {
+            stats.firstMatchTime = msecs;
+            // Known right away, so the cost of a runner is learned even if the query never finishes
+            stats.averageFirstMatchTime.add(msecs);
+        }
+        stats.lastMatchTime = msecs;
+        stats.matchCount = *it;
+        emitRowChanged(row);
+    }
+}
+
+void RunnerStatsModel::setDiscardedCounts(const QHash<QString, int> &counts)
+{
+    for (int i = 0; i < m_stats.count(); ++i) {
+        RunnerStats &stats = m_stats[i];
+        const int count = counts.value(stats.runnerId);
+        if (stats.discardedCount != count) {
+            stats.discardedCount = count;
+            emitRowChanged(i);
+        }
+    }
+}
+
+void RunnerStatsModel::queryFinished()
+{
+    if (!m_queryRunning) {
+        return;
+    }
+    m_queryRunning = false;
+
+    for (int i = 0; i < m_stats.count(); ++i) {
+        RunnerStats &stats = m_stats[i];
+        if (stats.firstMatchTime < 0) {
+            continue;
+        }
+
+        stats.averageLastMatchTime.add(stats.lastMatchTime);
+        stats.averageMatchCount.add(stats.matchCount);
+        stats.averageDiscardedCount.add(stats.discardedCount);
+        ++stats.queryCount;
+        emitRowChanged(i);
+    }
+}
+
+qreal RunnerStatsModel::averageFirstMatchTime(const QString &runnerId) const
+{
+    const auto it = m_rows.constFind(runnerId);
+    if (it == m_rows.constEnd()) {
+        return -1;
+    }
+    return m_stats.at(*it).averageFirstMatchTime.value();
+}
+
+void RunnerStatsModel::clear()
+{
+    // Only the current query is dropped, the averages are what the model is for
+    resetCurrentQuery();
+    m_queryRunning = false;
+}
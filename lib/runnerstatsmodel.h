@@ -0,0 +1,131 @@
+/*
+ * This file is part of the KDE Milou Project
+ * SPDX-FileCopyrightText: 2026 Milou Authors
+ *
+ * SPDX-License-Identifier: LGPL-2.1-only OR LGPL-3.0-only OR LicenseRef-KDE-Accepted-LGPL
+ *
+ */
+
+#pragma once
+
+#include <QAbstractListModel>
+#include <QHash>
+#include <QVector>
+
+#include <KRunner/QueryMatch>
+
+namespace Milou
+{
+/**
+ * An exponential moving average, recent samples weigh more
+ */
+class RollingAverage
+{
+public:
+    void add(qreal sample)
+    {
+        m_value = m_value < 0 ? sample : (1 - s_smoothing) * m_value + s_smoothing * sample;
+    }
+
+    /**
+     * The average, -1 if there were no samples yet
+     */
+    qreal value() const
+    {
+        return m_value;
+    }
+
+private:
+    // weight of the newest sample
+    static constexpr qreal s_smoothing = 0.3;
+
+    qreal m_value = -1;
+};
+
+/**
+ * How quickly and how much each runner answered, for the current query and on average
+ *
+ * There is a row for every runner that came up with matches since the model was created.
+ * Times are in milliseconds since the query was launched, -1 if the runner didn't answer
+ * the current query (yet). The averages are -1 until the runner answered a query.
+ */
+class RunnerStatsModel : public QAbstractListModel
+{
+    Q_OBJECT
+
+public:
+    explicit RunnerStatsModel(QObject *parent = nullptr);
+    ~RunnerStatsModel() override;
+
+    enum Roles {
+        RunnerIdRole = Qt::UserRole + 1,
+        FirstMatchTimeRole, ///< When the first match of the runner showed up
+        LastMatchTimeRole, ///< When the runner last came up with more or other matches
+        MatchCountRole,
+        DiscardedCountRole, ///< Matches not shown because their category exceeded its share of the limit
+        AverageFirstMatchTimeRole,
+        AverageLastMatchTimeRole,
+        AverageMatchCountRole,
+        AverageDiscardedCountRole,
+        QueryCountRole, ///< Number of finished queries the runner answered
+    };
+    Q_ENUM(Roles)
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    QHash<int, QByteArray> roleNames() const override;
+
+    /**
+     * Starts collecting the statistics of a new query
+     */
+    void queryLaunched();
+    /**
+     * Notes down the matches of the current query, @p msecs after it was launched
+     */
+    void matchesChanged(const QList<Plasma::QueryMatch> &matches, int msecs);
+    /**
+     * Notes down how many matches of each runner are currently not shown
+     */
+    void setDiscardedCounts(const QHash<QString /*runnerId*/, int> &counts);
+    /**
+     * Adds the statistics of the current query to the averages
+     */
+    void queryFinished();
+
+    /**
+     * Average milliseconds it took @p runnerId to come up with its first match, -1 if unknown
+     */
+    qreal averageFirstMatchTime(const QString &runnerId) const;
+
+    /**
+     * Drops the statistics of the current query, the averages are kept
+     */
+    void clear();
+
+private:
+    struct RunnerStats {
+        QString runnerId;
+        QString name;
+
+        int firstMatchTime = -1;
+        int lastMatchTime = -1;
+        int matchCount = 0;
+        int discardedCount = 0;
+
+        RollingAverage averageFirstMatchTime;
+        RollingAverage averageLastMatchTime;
+        RollingAverage averageMatchCount;
+        RollingAverage averageDiscardedCount;
+        int queryCount = 0;
+    };
+
+    int rowFor(const QString &runnerId, const QString &name);
+    void resetCurrentQuery();
+    void emitRowChanged(int row);
+
+    QVector<RunnerStats> m_stats;
+    QHash<QString /*runnerId*/, int /*row*/> m_rows;
+    bool m_queryRunning = false;
+};
+
+} // namespace Milou
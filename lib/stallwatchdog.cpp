@@ -0,0 +1,116 @@
+/*
+ * This file is part of the KDE Milou Project
+ * SPDX-FileCopyrightText: 2026 Milou Authors
+ *
+ * SPDX-License-Identifier: LGPL-2.1-only OR LGPL-3.0-only OR LicenseRef-KDE-Accepted-LGPL
+ *
+ */
+
+#include "stallwatchdog.h"
+
+#include "milou_perf_debug.h"
+
+#include <QAbstractItemModel>
+#include <QTimer>
+
+using namespace Milou;
+
+Q_GLOBAL_STATIC(StallWatchdog, s_watchdog)
+
+StallWatchdog *StallWatchdog::instance()
+{
+    return s_watchdog();
+}
+
+StallWatchdog::StallWatchdog()
+{
+    bool ok;
+    const int threshold = qEnvironmentVariableIntValue("MILOU_STALL_THRESHOLD", &ok);
+    if (ok && threshold > 0) {
+        m_threshold = threshold;
+    }
+}
+
+StallWatchdog::~StallWatchdog() = default;
+
+bool StallWatchdog::isEnabled() const
+{
+    return MILOU_PERF().isInfoEnabled();
+}
+
+int StallWatchdog::threshold() const
+{
+    return m_threshold;
+}
+
+void StallWatchdog::setQueryLength(int length)
+{
+    m_queryLength = length;
+}
+
+int StallWatchdog::rowCount(const QAbstractItemModel *model)
+{
+    const int topLevelRows = model->rowCount();
+    int rows = topLevelRows;
+    for (int i = 0; i < topLevelRows; ++i) {
+        rows += model->rowCount(model->index(i, 0));
+    }
+    return rows;
+}
+
+void StallWatchdog::check(const QByteArray &stage, qint64 nsecs, const QAbstractItemModel *model)
+{
+    if (nsecs > m_threshold * qint64(1000000) && isEnabled()) {
+        report(stage, nsecs, model ? rowCount(model) : -1);
+    }
+}
+
+void StallWatchdog::addDataTime(qint64 nsecs, const QAbstractItemModel *model)
+{
+    if (m_dataReads == 0) {
+        m_dataModel = model;
+        QTimer::singleShot(0, [this] {
+            const qint64 dataTime = m_dataTime;
+            const int dataReads = m_dataReads;
+            m_dataTime = 0;
+            m_dataReads = 0;
+
+            check("data burst of " + QByteArray::number(dataReads) + " reads", dataTime, m_dataModel.data());
+        });
+    }
+
+    m_dataTime += nsecs;
+    ++m_dataReads;
+}
+
+void StallWatchdog::report(const QByteArray &stage, qint64 nsecs, int rows)
+{
+    if (m_sinceLastLog.isValid() && m_sinceLastLog.elapsed() < s_minLogInterval) {
+        ++m_suppressedStalls;
+        return;
+    }
+    m_sinceLastLog.start();
+
+    qCInfo(MILOU_PERF).nospace() << stage.constData() << " blocked for " << nsecs / 1000000.0 << "ms, query length " << m_queryLength << ", " << rows
+                                 << " rows";
+    if (m_suppressedStalls > 0) {
+        qCInfo(MILOU_PERF) << m_suppressedStalls << "more stalls since the previous one were not logged";
+        m_suppressedStalls = 0;
+    }
+}
+
+StallWatchdog::Scope::Scope(const char *stage, const QAbstractItemModel *model)
+    : m_stage(stage)
+    , m_model(model)
+{
+    if (StallWatchdog::instance()->isEnabled()) {
+        m_timer.start();
+    }
+}
+
+StallWatchdog::Scope::~Scope()
+{
+    if (m_timer.isValid()) {
+        StallWatchdog::instance()->check(QByteArray::fromRawData(m_stage, qstrlen(m_stage)), m_timer.nsecsElapsed(), m_model);
+    }
+}
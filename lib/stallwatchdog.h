@@ -0,0 +1,100 @@
+/*
+ * This file is part of the KDE Milou Project
+ * SPDX-FileCopyrightText: 2026 Milou Authors
+ *
+ * SPDX-License-Identifier: LGPL-2.1-only OR LGPL-3.0-only OR LicenseRef-KDE-Accepted-LGPL
+ *
+ */
+
+#pragma once
+
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QPointer>
+
+class QAbstractItemModel;
+
+namespace Milou
+{
+/**
+ * Logs when a stage of the models blocks the GUI thread for too long
+ *
+ * The stages time themselves and report here, e.g. the proxies re-sorting or
+ * handling the matches of the runners, and the views reading lots of data at once.
+ * A stall is logged through the milou.perf category with the stage, its duration,
+ * the length of the query and the number of rows of the stage, at most once a second.
+ *
+ * The watchdog is off unless info messages of milou.perf are enabled, e.g. with
+ * QT_LOGGING_RULES="milou.perf.info=true". The threshold is 50ms, the
+ * MILOU_STALL_THRESHOLD environment variable overrides it.
+ */
+class StallWatchdog
+{
+public:
+    static StallWatchdog *instance();
+
+    bool isEnabled() const;
+    /**
+     * Milliseconds a stage may block before it is reported
+     */
+    int threshold() const;
+
+    /**
+     * Length of the query being run, for context
+     */
+    void setQueryLength(int length);
+
+    /**
+     * Reports that @p stage took @p nsecs, which is logged if that exceeds the threshold
+     */
+    void check(const QByteArray &stage, qint64 nsecs, const QAbstractItemModel *model);
+
+    /**
+     * Adds to the time the views spent reading the data of @p model in this turn of the event loop
+     *
+     * Each read is quick but a view creating its delegates reads thousands,
+     * they are checked as a whole once the event loop is back.
+     */
+    void addDataTime(qint64 nsecs, const QAbstractItemModel *model);
+
+    /**
+     * Rows of @p model and, for the models still holding the categories, the rows within
+     */
+    static int rowCount(const QAbstractItemModel *model);
+
+    /**
+     * Checks the time between its creation and destruction
+     */
+    class Scope
+    {
+    public:
+        Scope(const char *stage, const QAbstractItemModel *model);
+        ~Scope();
+
+    private:
+        const char *m_stage;
+        const QAbstractItemModel *m_model;
+        QElapsedTimer m_timer;
+    };
+
+    StallWatchdog();
+    ~StallWatchdog();
+
+private:
+    void report(const QByteArray &stage, qint64 nsecs, int rows);
+
+    static constexpr int s_defaultThreshold = 50;
+    static constexpr int s_minLogInterval = 1000;
+
+    int m_threshold = s_defaultThreshold;
+    int m_queryLength = 0;
+
+    QElapsedTimer m_sinceLastLog;
+    int m_suppressedStalls = 0;
+
+    qint64 m_dataTime = 0;
+    int m_dataReads = 0;
+    QPointer<const QAbstractItemModel> m_dataModel;
+};
+
+} // namespace Milou
@@ -0,0 +1,105 @@
+/*
+ * This file is part of the KDE Milou Project
+ * SPDX-FileCopyrightText: 2026 Milou Authors
+ *
+ * SPDX-License-Identifier: LGPL-2.1-only OR LGPL-3.0-only OR LicenseRef-KDE-Accepted-LGPL
+ *
+ */
+
+#include "storedmatch.h"
+
+#include <QDataStream>
+#include <QUrl>
+
+#include <KRunner/AbstractRunner>
+#include <KRunner/RunnerManager>
+
+using namespace Milou;
+
+bool StoredMatch::isStorable(const Plasma::QueryMatch &match)
+{
+    // Anything else, like the lists some runners keep, wouldn't survive the round trip
+    const QVariant data = match.data();
+    return data.isNull() || data.userType() == QMetaType::QString || data.userType() == QMetaType::QUrl;
+}
+
+StoredMatch StoredMatch::fromQueryMatch(const Plasma::QueryMatch &match)
+{
+    StoredMatch stored;
+    stored.runnerId = match.runner() ? match.runner()->id() : QString();
+    stored.id = match.id();
+    stored.text = match.text();
+    stored.subtext = match.subtext();
+    stored.iconName = match.iconName();
+    stored.category = match.matchCategory();
+    if (isStorable(match)) {
+        stored.data = match.data();
+    }
+    const auto urls = match.urls();
+    for (const QUrl &url : urls) {
+        stored.urls.append(url.toString());
+    }
+    stored.type = match.type();
+    stored.relevance = match.relevance();
+    return stored;
+}
+
+Plasma::QueryMatch StoredMatch::toQueryMatch(Plasma::RunnerManager *manager) const
+{
+    Plasma::AbstractRunner *runner = manager->runner(runnerId);
+    if (!runner) {
+        return Plasma::QueryMatch(nullptr);
+    }
+
+    Plasma::QueryMatch match(runner);
+    // setData also sets the id, so set the id afterwards
+    if (!data.isNull()) {
+        match.setData(data);
+    }
+    // QueryMatch prefixes the id with that of the runner itself
+    const QString runnerPrefix = runnerId + QLatin1Char('_');
+    match.setId(id.startsWith(runnerPrefix) ? id.mid(runnerPrefix.size()) : id);
+    match.setText(text);
+    match.setSubtext(subtext);
+    match.setIconName(iconName);
+    match.setMatchCategory(category);
+    match.setType(static_cast<Plasma::QueryMatch::Type>(type));
+    match.setRelevance(relevance);
+
+    QList<QUrl> matchUrls;
+    matchUrls.reserve(urls.count());
+    for (const QString &url : urls) {
+        matchUrls.append(QUrl(url));
+    }
+    match.setUrls(matchUrls);
+
+    return match;
+}
+
+QString StoredMatch::key() const
+{
+    return runnerId + QLatin1Char('/') + id;
+}
+
+QString StoredMatch::key(const Plasma::QueryMatch &match)
+{
+    return (match.runner() ? match.runner()->id() : QString()) + QLatin1Char('/') + match.id();
+}
+
+QDataStream &Milou::operator<<(QDataStream &stream, const StoredMatch &match)
+{
+    // FrecencyStore::readText expects the text to follow the ids
+    stream << match.runnerId << match.id << match.text << match.subtext << match.iconName << match.category << match.data << match.urls << qint32(match.type)
+           << double(match.relevance);
+    return stream;
+}
+
+QDataStream &Milou::operator>>(QDataStream &stream, StoredMatch &match)
+{
+    qint32 type;
+    double relevance;
+    stream >> match.runnerId >> match.id >> match.text >> match.subtext >> match.iconName >> match.category >> match.data >> match.urls >> type >> relevance;
+    match.type = type;
+    match.relevance = relevance;
+    return stream;
+}
@@ -0,0 +1,65 @@
+/*
+ * This file is part of the KDE Milou Project
+ * SPDX-FileCopyrightText: 2026 Milou Authors
+ *
+ * SPDX-License-Identifier: LGPL-2.1-only OR LGPL-3.0-only OR LicenseRef-KDE-Accepted-LGPL
+ *
+ */
+
+#pragma once
+
+#include <QString>
+#include <QStringList>
+#include <QVariant>
+
+#include <KRunner/QueryMatch>
+
+class QDataStream;
+
+namespace Plasma
+{
+class RunnerManager;
+}
+
+namespace Milou
+{
+/**
+ * A QueryMatch reduced to what is needed to show and run it again later
+ *
+ * This is what is written to disk. Runners get the data of a match back when it is run,
+ * so only matches whose data is a string or a URL, or that have none, can be stored.
+ */
+struct StoredMatch {
+    QString runnerId;
+    QString id;
+    QString text;
+    QString subtext;
+    QString iconName;
+    QString category;
+    QVariant data;
+    QStringList urls;
+    int type = Plasma::QueryMatch::NoMatch;
+    qreal relevance = 0;
+
+    /**
+     * Whether the match can be stored and run again later
+     */
+    static bool isStorable(const Plasma::QueryMatch &match);
+    static StoredMatch fromQueryMatch(const Plasma::QueryMatch &match);
+
+    /**
+     * Recreates the match, the match is invalid if its runner isn't loaded in @p manager
+     */
+    Plasma::QueryMatch toQueryMatch(Plasma::RunnerManager *manager) const;
+
+    /**
+     * Identifies the match across queries
+     */
+    QString key() const;
+    static QString key(const Plasma::QueryMatch &match);
+};
+
+QDataStream &operator<<(QDataStream &stream, const StoredMatch &match);
+QDataStream &operator>>(QDataStream &stream, StoredMatch &match);
+
+} // namespace Milou
@@ -0,0 +1,192 @@
+/*
+ * This file is part of the KDE Milou Project
+ * SPDX-FileCopyrightText: 2026 Milou Authors
+ *
+ * SPDX-License-Identifier: LGPL-2.1-only OR LGPL-3.0-only OR LicenseRef-KDE-Accepted-LGPL
+ *
+ */
+
+#include <QApplication>
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QQmlComponent>
+#include <QQmlContext>
+#include <QQmlEngine>
+#include <QQuickItem>
+#include <QQuickWindow>
+#include <QStandardItemModel>
+
+#include "../resultrowitem.h"
+
+using namespace Milou;
+
+// Compares ResultDelegate.qml to ResultRowDelegate.qml, built around the C++ ResultRow,
+// in a ListView: how long it takes to create or rebind the delegates after a model reset,
+// and how long a frame takes while scrolling through them
+static const char s_qml[] = R"(
+import QtQuick 2.15
+import QtQuick.Window 2.15
+import org.kde.plasma.core 2.0 as PlasmaCore
+
+Window {
+    width: 600
+    height: 800
+    visible: true
+
+    ListView {
+        id: listView
+        objectName: "listView"
+        anchors.fill: parent
+        cacheBuffer: 0
+        model: benchmarkModel
+        section.property: "category"
+        delegate: useNativeDelegate ? nativeDelegate : qmlDelegate
+        reuseItems: reuseDelegates
+
+        property bool moved: false
+        function mouseMovedGlobally() {
+            return false;
+        }
+
+        Component {
+            id: qmlDelegate
+
+            ResultDelegate {
+                width: listView.width
+            }
+        }
+
+        Component {
+            id: nativeDelegate
+
+            ResultRowDelegate {
+                width: listView.width
+            }
+        }
+    }
+}
+)";
+
+enum Roles {
+    CategoryRole = Qt::UserRole + 1,
+    SubtextRole,
+    DuplicateRole,
+    MultiLineRole,
+    ActionsRole,
+    MatchKeyRole,
+};
+
+static void fillModel(QStandardItemModel *model, int generation)
+{
+    static const QStringList icons = {
+        QStringLiteral("system-run"),
+        QStringLiteral("folder"),
+        QStringLiteral("text-plain"),
+        QStringLiteral("preferences-system"),
+        QStringLiteral("internet-web-browser"),
+    };
+
+    model->clear();
+    for (int i = 0; i < 200; ++i) {
+        auto *item = new QStandardItem(QStringLiteral("Result %1 of query %2").arg(i).arg(generation));
+        item->setData(QStringLiteral("/home/user/Documents/result-%1").arg(i), SubtextRole);
+        item->setData(QStringLiteral("Category %1").arg(i / 5), CategoryRole);
+        item->setData(icons.at(i % icons.count()), Qt::DecorationRole);
+        item->setData(false, DuplicateRole);
+        item->setData(false, MultiLineRole);
+        item->setData(QVariantList(), ActionsRole);
+        // Later queries come up with the same matches
+        item->setData(QStringLiteral("benchmark/%1").arg(i), MatchKeyRole);
+        model->appendRow(item);
+    }
+}
+
+static void benchmark(QQmlEngine *engine, QStandardItemModel *model, bool native, bool reuse)
+{
+    engine->rootContext()->setContextProperty(QStringLiteral("useNativeDelegate"), native);
+    engine->rootContext()->setContextProperty(QStringLiteral("reuseDelegates"), reuse);
+
+    QQmlComponent component(engine);
+    component.setData(s_qml, QUrl::fromLocalFile(QStringLiteral(MILOU_QML_SOURCE_DIR "/benchmark.qml")));
+    QScopedPointer<QObject> object(component.create());
+    auto *window = qobject_cast<QQuickWindow *>(object.data());
+    if (!window) {
+        qWarning() << component.errors();
+        return;
+    }
+
+    auto *listView = window->findChild<QQuickItem *>(QStringLiteral("listView"));
+
+    // Creating delegates, like ResultsView does for every query
+    const int resets = 20;
+    qint64 creationTime = 0;
+    int createdDelegates = 0;
+    for (int i = 0; i < resets; ++i) {
+        QElapsedTimer timer;
+        timer.start();
+        fillModel(model, i);
+        QMetaObject::invokeMethod(listView, "forceLayout");
+        creationTime += timer.nsecsElapsed();
+        createdDelegates += listView->property("contentItem").value<QQuickItem *>()->childItems().count();
+    }
+
+    // Scrolling, one step per frame
+    const int frames = 300;
+    int frame = 0;
+    qint64 frameTime = 0;
+    QElapsedTimer frameTimer;
+    QObject::connect(window, &QQuickWindow::afterRendering, window, [&] {
+        if (frameTimer.isValid()) {
+            frameTime += frameTimer.nsecsElapsed();
+            frameTimer.invalidate();
+        }
+    });
+    QObject::connect(window, &QQuickWindow::frameSwapped, window, [&] {
+        if (++frame > frames) {
+            QCoreApplication::quit();
+            return;
+        }
+        frameTimer.start();
+        listView->setProperty("contentY", (frame * 7) % 4000);
+        listView->setProperty("currentIndex", frame % 200);
+    });
+    window->update();
+    QCoreApplication::exec();
+
+    qDebug() << (native ? "ResultRowDelegate.qml" : "ResultDelegate.qml") << (reuse ? "reusing delegates:" : "creating delegates:");
+    qDebug() << "  creation per row" << creationTime / qMax(1, createdDelegates) / 1000.0 << "us";
+    qDebug() << "  time per frame" << frameTime / frames / 1000.0 << "us";
+}
+
+int main(int argc, char **argv)
+{
+    // Polish, sync and render on the same thread so a frame can be timed as a whole
+    qputenv("QSG_RENDER_LOOP", "basic");
+
+    QApplication app(argc, argv);
+
+    // ResultRowDelegate.qml imports it from the plugin, which isn't built into the benchmark
+    qmlRegisterType<ResultRowItem>("org.kde.milou", 0, 3, "ResultRow");
+
+    QStandardItemModel model;
+    model.setItemRoleNames({
+        {Qt::DisplayRole, QByteArrayLiteral("display")},
+        {Qt::DecorationRole, QByteArrayLiteral("decoration")},
+        {CategoryRole, QByteArrayLiteral("category")},
+        {SubtextRole, QByteArrayLiteral("subtext")},
+        {DuplicateRole, QByteArrayLiteral("isDuplicate")},
+        {MultiLineRole, QByteArrayLiteral("multiLine")},
+        {ActionsRole, QByteArrayLiteral("actions")},
+        {MatchKeyRole, QByteArrayLiteral("matchKey")},
+    });
+
+    QQmlEngine engine;
+    engine.rootContext()->setContextProperty(QStringLiteral("benchmarkModel"), &model);
+
+    benchmark(&engine, &model, false, false);
+    benchmark(&engine, &model, false, true);
+    benchmark(&engine, &model, true, false);
+    benchmark(&engine, &model, true, true);
+
+    return 0;
+}
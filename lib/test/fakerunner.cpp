@@ -0,0 +1,102 @@
+/*
+ * This file is part of the KDE Milou Project
+ * SPDX-FileCopyrightText: 2026 Milou Authors
+ *
+ * SPDX-License-Identifier: LGPL-2.1-only OR LGPL-3.0-only OR LicenseRef-KDE-Accepted-LGPL
+ *
+ */
+
+#include <KPluginFactory>
+#include <KRunner/AbstractRunner>
+#include <KRunner/RunnerContext>
+#include <KRunner/RunnerSyntax>
+
+#include <QAtomicInt>
+#include <QElapsedTimer>
+#include <QThread>
+
+/**
+ * A runner whose answers the tests know in advance
+ *
+ * Every query gets an exact match with the query as its text right away, along
+ * with a few possible matches whose number depends on the length of the query
+ * and whose texts repeat. The runner then stays busy for the milliseconds set
+ * in the "delay" property, so tests can type while a query with matches is running.
+ * Queries starting with "define" are routed to it alone.
+ */
+class FakeRunner : public Plasma::AbstractRunner
+{
+    Q_OBJECT
+    Q_PROPERTY(int delay READ delay WRITE setDelay)
+    /**
+     * The data of the match that was run last
+     */
+    Q_PROPERTY(QVariant lastRunData READ lastRunData)
+
+public:
+    FakeRunner(QObject *parent, const KPluginMetaData &metaData, const QVariantList &args)
+        : Plasma::AbstractRunner(parent, metaData, args)
+    {
+        addSyntax(Plasma::RunnerSyntax(QStringLiteral("define :q:"), QStringLiteral("Defines :q:")));
+    }
+
+    int delay() const
+    {
+        return m_delay.loadRelaxed();
+    }
+
+    void setDelay(int delay)
+    {
+        m_delay.storeRelaxed(delay);
+    }
+
+    void match(Plasma::RunnerContext &context) override
+    {
+        const QString query = context.query();
+
+        QList<Plasma::QueryMatch> matches;
+
+        Plasma::QueryMatch exactMatch(this);
+        exactMatch.setId(query);
+        exactMatch.setType(Plasma::QueryMatch::ExactMatch);
+        exactMatch.setText(query);
+        exactMatch.setRelevance(1);
+        matches.append(exactMatch);
+
+        for (int i = 0; i < query.length() % 5 + 2; ++i) {
+            Plasma::QueryMatch match(this);
+            match.setId(query + QString::number(i));
+            match.setType(Plasma::QueryMatch::PossibleMatch);
+            match.setText(QStringLiteral("Item %1").arg((query.length() + i) % 3));
+            match.setRelevance(0.5 - i / 10.0);
+            matches.append(match);
+        }
+
+        context.addMatches(matches);
+
+        QElapsedTimer timer;
+        timer.start();
+        while (context.isValid() && timer.elapsed() < delay()) {
+            QThread::msleep(10);
+        }
+    }
+
+    void run(const Plasma::RunnerContext &context, const Plasma::QueryMatch &match) override
+    {
+        Q_UNUSED(context)
+        m_lastRunData = match.data();
+    }
+
+    QVariant lastRunData() const
+    {
+        return m_lastRunData;
+    }
+
+private:
+    QAtomicInt m_delay = 0;
+    QVariant m_lastRunData;
+};
+
+K_PLUGIN_CLASS_WITH_JSON(FakeRunner, "fakerunner.json")
+
+#include "fakerunner.moc"
@@ -0,0 +1,236 @@
+/*
+ * This file is part of the KDE Milou Project
+ * SPDX-FileCopyrightText: 2026 Milou Authors
+ *
+ * SPDX-License-Identifier: LGPL-2.1-only OR LGPL-3.0-only OR LicenseRef-KDE-Accepted-LGPL
+ *
+ */
+
+#include <QFile>
+#include <QFileInfo>
+#include <QTemporaryDir>
+#include <QTest>
+#include <QUrl>
+
+#include <KPluginMetaData>
+#include <KRunner/AbstractRunner>
+#include <KRunner/QueryMatch>
+#include <KRunner/RunnerManager>
+
+#include "../frecencystore.h"
+
+using namespace Milou;
+
+static Plasma::QueryMatch createMatch(const QString &id)
+{
+    Plasma::QueryMatch match(nullptr);
+    match.setId(id);
+    match.setText(id);
+    match.setSubtext(QStringLiteral("Subtext of %1").arg(id));
+    match.setType(Plasma::QueryMatch::PossibleMatch);
+    match.setRelevance(0.5);
+    return match;
+}
+
+// Where the header says the complete records end
+static quint64 usedSize(const QString &fileName)
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly) || !file.seek(16)) {
+        return 0;
+    }
+    quint64 used = 0;
+    file.read(reinterpret_cast<char *>(&used), sizeof(used));
+    return used;
+}
+
+class FrecencyStoreTest : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void testRoundTrip();
+    void testCorruptTail();
+    void testCompaction();
+    void testRestoredMatchRuns();
+};
+
+void FrecencyStoreTest::testRoundTrip()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString fileName = dir.filePath(QStringLiteral("frecency"));
+
+    FrecencyStore writer(fileName);
+    writer.recordLaunch(createMatch(QStringLiteral("firefox")));
+    writer.recordLaunch(createMatch(QStringLiteral("firefox")));
+    writer.recordLaunch(createMatch(QStringLiteral("kate")));
+
+    // Another process reading the same file
+    FrecencyStore reader(fileName);
+    QCOMPARE(reader.count(), 2);
+
+    const QVector<StoredMatch> matches = reader.recentMatches(QString(), 10);
+    QCOMPARE(matches.count(), 2);
+    QCOMPARE(matches.at(0).text, QStringLiteral("firefox"));
+    QCOMPARE(matches.at(0).subtext, QStringLiteral("Subtext of firefox"));
+    QCOMPARE(matches.at(0).type, int(Plasma::QueryMatch::PossibleMatch));
+    QCOMPARE(matches.at(1).text, QStringLiteral("kate"));
+    QVERIFY(reader.score(matches.at(0).key()) > reader.score(matches.at(1).key()));
+
+    QCOMPARE(reader.recentMatches(QStringLiteral("ka"), 10).count(), 1);
+    QCOMPARE(reader.score(QStringLiteral("/unknown")), 0.0);
+
+    // The reader catches up with launches recorded after it loaded the file
+    for (int i = 0; i < 3; ++i) {
+        writer.recordLaunch(createMatch(QStringLiteral("kate")));
+    }
+    writer.recordLaunch(createMatch(QStringLiteral("dolphin")));
+
+    QCOMPARE(reader.count(), 3);
+    QCOMPARE(reader.recentMatches(QString(), 1).at(0).text, QStringLiteral("kate"));
+
+    // And both append to the same log
+    reader.recordLaunch(createMatch(QStringLiteral("dolphin")));
+    QCOMPARE(writer.count(), 3);
+    const QString dolphinKey = StoredMatch::key(createMatch(QStringLiteral("dolphin")));
+    QVERIFY(qAbs(writer.score(dolphinKey) - reader.score(dolphinKey)) < 0.001);
+}
+
+void FrecencyStoreTest::testCorruptTail()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString fileName = dir.filePath(QStringLiteral("frecency"));
+
+    {
+        FrecencyStore store(fileName);
+        store.recordLaunch(createMatch(QStringLiteral("firefox")));
+        store.recordLaunch(createMatch(QStringLiteral("kate")));
+        QCOMPARE(store.count(), 2);
+    }
+
+    // Cut the last record off in the middle
+    const quint64 used = usedSize(fileName);
+    QVERIFY(used > 0);
+    QVERIFY(QFile::resize(fileName, qint64(used) - 5));
+
+    {
+        FrecencyStore store(fileName);
+        QCOMPARE(store.count(), 1);
+        QCOMPARE(store.recentMatches(QString(), 10).at(0).text, QStringLiteral("firefox"));
+
+        // What is left of the record is overwritten
+        store.recordLaunch(createMatch(QStringLiteral("dolphin")));
+        QCOMPARE(store.count(), 2);
+    }
+
+    FrecencyStore store(fileName);
+    QCOMPARE(store.count(), 2);
+    QVERIFY(usedSize(fileName) <= quint64(QFileInfo(fileName).size()));
+
+    const QVector<StoredMatch> matches = store.recentMatches(QString(), 10);
+    QCOMPARE(matches.count(), 2);
+    QVERIFY(matches.at(0).text == QLatin1String("dolphin") || matches.at(1).text == QLatin1String("dolphin"));
+
+    // Garbage isn't taken for a store
+    QFile garbage(dir.filePath(QStringLiteral("garbage")));
+    QVERIFY(garbage.open(QIODevice::WriteOnly));
+    garbage.write(QByteArray(100, 'x'));
+    garbage.close();
+
+    FrecencyStore garbageStore(garbage.fileName());
+    QCOMPARE(garbageStore.count(), 0);
+    garbageStore.recordLaunch(createMatch(QStringLiteral("firefox")));
+    QCOMPARE(garbageStore.count(), 1);
+}
+
+void FrecencyStoreTest::testCompaction()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString fileName = dir.filePath(QStringLiteral("frecency"));
+
+    FrecencyStore writer(fileName);
+    FrecencyStore reader(fileName);
+
+    writer.recordLaunch(createMatch(QStringLiteral("kate")));
+    writer.recordLaunch(createMatch(QStringLiteral("firefox")));
+    QCOMPARE(reader.count(), 2);
+    const quint64 initialSize = usedSize(fileName);
+
+    // Every launch supersedes the previous record of the match, eventually the file is compacted
+    for (int i = 0; i < 300; ++i) {
+        writer.recordLaunch(createMatch(QStringLiteral("firefox")));
+    }
+
+    QCOMPARE(writer.count(), 2);
+    // Without compaction there'd be about 150 times as many records
+    QVERIFY(usedSize(fileName) < 50 * initialSize);
+
+    // The reader still had the old file, it notices it was replaced
+    const QString firefoxKey = StoredMatch::key(createMatch(QStringLiteral("firefox")));
+    QCOMPARE(reader.count(), 2);
+    QVERIFY(reader.score(firefoxKey) > 100);
+    QCOMPARE(reader.recentMatches(QString(), 10).at(0).text, QStringLiteral("firefox"));
+
+    // and appends to the new file
+    reader.recordLaunch(createMatch(QStringLiteral("dolphin")));
+    QCOMPARE(writer.count(), 3);
+
+    FrecencyStore store(fileName);
+    QCOMPARE(store.count(), 3);
+    QVERIFY(qAbs(store.score(firefoxKey) - writer.score(firefoxKey)) < 0.001);
+
+    // Once too many matches were launched, the store drops enough of the lowest scoring ones
+    // that the next few new matches don't rewrite it again
+    for (int i = store.count(); i <= FrecencyStore::s_maxEntries; ++i) {
+        store.recordLaunch(createMatch(QStringLiteral("match %1").arg(i)));
+    }
+    QCOMPARE(store.count(), FrecencyStore::s_compactedEntries);
+    QVERIFY(store.score(firefoxKey) > 100);
+
+    const quint64 compactedSize = usedSize(fileName);
+    store.recordLaunch(createMatch(QStringLiteral("new match")));
+    QCOMPARE(store.count(), FrecencyStore::s_compactedEntries + 1);
+    QVERIFY(usedSize(fileName) > compactedSize);
+}
+
+void FrecencyStoreTest::testRestoredMatchRuns()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+
+    Plasma::RunnerManager manager;
+    manager.loadRunner(KPluginMetaData(QStringLiteral(MILOU_FAKERUNNER_PATH)));
+    Plasma::AbstractRunner *runner = manager.runner(QStringLiteral("milou_fakerunner"));
+    QVERIFY(runner);
+
+    FrecencyStore store(dir.filePath(QStringLiteral("frecency")));
+
+    Plasma::QueryMatch urlMatch(runner);
+    urlMatch.setId(QStringLiteral("url"));
+    urlMatch.setText(QStringLiteral("URL"));
+    urlMatch.setData(QUrl(QStringLiteral("file:///tmp")));
+    store.recordLaunch(urlMatch);
+
+    // The runner would get an empty list back, it is better not to offer the match again
+    Plasma::QueryMatch listMatch(runner);
+    listMatch.setId(QStringLiteral("list"));
+    listMatch.setText(QStringLiteral("List"));
+    listMatch.setData(QVariantList{QStringLiteral("process"), 42});
+    store.recordLaunch(listMatch);
+
+    const QVector<StoredMatch> matches = store.recentMatches(QString(), 10);
+    QCOMPARE(matches.count(), 1);
+
+    const Plasma::QueryMatch restored = matches.at(0).toQueryMatch(&manager);
+    QVERIFY(restored.isValid());
+    QCOMPARE(restored.id(), urlMatch.id());
+    manager.run(restored);
+    QCOMPARE(runner->property("lastRunData"), QVariant(QUrl(QStringLiteral("file:///tmp"))));
+}
+
+QTEST_GUILESS_MAIN(FrecencyStoreTest)
+
+#include "frecencystoretest.moc"
@@ -0,0 +1,122 @@
+/*
+ * This file is part of the KDE Milou Project
+ * SPDX-FileCopyrightText: 2026 Milou Authors
+ *
+ * SPDX-License-Identifier: LGPL-2.1-only OR LGPL-3.0-only OR LicenseRef-KDE-Accepted-LGPL
+ *
+ */
+
+#include <QFile>
+#include <QTemporaryDir>
+#include <QTest>
+
+#include <limits>
+
+#include "../latencyhistograms.h"
+
+using namespace Milou;
+
+class LatencyHistogramsTest : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void testBuckets();
+    void testPersistence();
+    void testOtherVersion();
+};
+
+void LatencyHistogramsTest::testBuckets()
+{
+    QCOMPARE(LatencyHistograms::bucket(0), 0);
+    for (int msecs : {1, 3, 17, 250, 4000}) {
+        const int bucket = LatencyHistograms::bucket(msecs);
+        QVERIFY(msecs < LatencyHistograms::bucketUpperBound(bucket));
+        QVERIFY(msecs >= LatencyHistograms::bucketUpperBound(bucket - 1));
+    }
+    QCOMPARE(LatencyHistograms::bucket(std::numeric_limits<int>::max()), LatencyHistograms::s_bucketCount - 1);
+}
+
+void LatencyHistogramsTest::testPersistence()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString fileName = dir.filePath(QStringLiteral("milou/latency"));
+
+    {
+        LatencyHistograms histograms(fileName);
+        QVERIFY(!histograms.openExisting());
+    }
+
+    {
+        LatencyHistograms histograms(fileName);
+        QCOMPARE(histograms.percentile(LatencyHistograms::KeystrokeToStable, 50), qreal(-1));
+        for (int i = 0; i < 90; ++i) {
+            histograms.record(LatencyHistograms::KeystrokeToStable, 10);
+        }
+        for (int i = 0; i < 10; ++i) {
+            histograms.record(LatencyHistograms::KeystrokeToStable, 1000);
+        }
+        histograms.record(LatencyHistograms::ActivationToLaunch, 5);
+        histograms.record(LatencyHistograms::RunToLaunch, 5);
+        histograms.record(LatencyHistograms::RunToLaunch, 7);
+    }
+
+    // The latencies persist and don't leak into the other metrics
+    LatencyHistograms histograms(fileName);
+    QVERIFY(histograms.openExisting(true));
+    QCOMPARE(histograms.count(LatencyHistograms::KeystrokeToStable), quint64(100));
+    QCOMPARE(histograms.count(LatencyHistograms::ActivationToLaunch), quint64(1));
+    QCOMPARE(histograms.count(LatencyHistograms::RunToLaunch), quint64(2));
+    QCOMPARE(histograms.count(LatencyHistograms::KeystrokeToFirstResult), quint64(0));
+    QCOMPARE(histograms.percentile(LatencyHistograms::KeystrokeToStable, 90), LatencyHistograms::bucketUpperBound(LatencyHistograms::bucket(10)));
+    QCOMPARE(histograms.percentile(LatencyHistograms::KeystrokeToStable, 99), LatencyHistograms::bucketUpperBound(LatencyHistograms::bucket(1000)));
+
+    // Opened read-only, nothing is written
+    LatencyHistograms reader(fileName);
+    QVERIFY(reader.openExisting());
+    reader.reset();
+    reader.record(LatencyHistograms::KeystrokeToStable, 10);
+    QCOMPARE(reader.count(LatencyHistograms::KeystrokeToStable), quint64(100));
+
+    histograms.reset();
+    QCOMPARE(histograms.count(LatencyHistograms::KeystrokeToStable), quint64(0));
+}
+
+void LatencyHistogramsTest::testOtherVersion()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString fileName = dir.filePath(QStringLiteral("milou/latency"));
+
+    LatencyHistograms histograms(fileName);
+    histograms.record(LatencyHistograms::KeystrokeToStable, 10);
+
+    // Pretend another version wrote it, the version follows the magic
+    QFile file(fileName);
+    QVERIFY(file.open(QIODevice::ReadWrite));
+    QVERIFY(file.seek(4));
+    const quint32 otherVersion = 0;
+    file.write(reinterpret_cast<const char *>(&otherVersion), sizeof(otherVersion));
+    file.close();
+
+    // Reading it leaves it alone
+    LatencyHistograms reader(fileName);
+    QVERIFY(!reader.openExisting(true));
+    quint32 version = 1;
+    QVERIFY(file.open(QIODevice::ReadOnly));
+    QVERIFY(file.seek(4));
+    file.read(reinterpret_cast<char *>(&version), sizeof(version));
+    file.close();
+    QCOMPARE(version, otherVersion);
+
+    // Recording into it replaces it, rather than truncating it under whoever has it mapped
+    LatencyHistograms newHistograms(fileName);
+    QVERIFY(newHistograms.open());
+    QCOMPARE(newHistograms.count(LatencyHistograms::KeystrokeToStable), quint64(0));
+    QCOMPARE(histograms.count(LatencyHistograms::KeystrokeToStable), quint64(1));
+}
+
+QTEST_GUILESS_MAIN(LatencyHistogramsTest)
+
+#include "latencyhistogramstest.moc"
@@ -0,0 +1,118 @@
+/*
+ * This file is part of the KDE Milou Project
+ * SPDX-FileCopyrightText: 2026 Milou Authors
+ *
+ * SPDX-License-Identifier: LGPL-2.1-only OR LGPL-3.0-only OR LicenseRef-KDE-Accepted-LGPL
+ *
+ */
+
+#include <QCoreApplication>
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QEventLoop>
+#include <QTemporaryDir>
+
+#include <KRunner/RunnerManager>
+
+#include "../frecencyprovider.h"
+#include "../frecencystore.h"
+
+using namespace Milou;
+
+// How long the services runner takes to come up with its first matches for @p query, -1 if it found nothing
+static qint64 runnerTime(Plasma::RunnerManager *manager, const QString &query, QList<Plasma::QueryMatch> *matches)
+{
+    QEventLoop loop;
+    QElapsedTimer timer;
+    qint64 time = -1;
+
+    QObject::connect(manager, &Plasma::RunnerManager::matchesChanged, &loop, [&](const QList<Plasma::QueryMatch> &newMatches) {
+        if (newMatches.isEmpty() || time >= 0) {
+            return;
+        }
+        time = timer.nsecsElapsed();
+        if (matches) {
+            *matches = newMatches;
+        }
+        loop.quit();
+    });
+    QObject::connect(manager, &Plasma::RunnerManager::queryFinished, &loop, &QEventLoop::quit);
+
+    timer.start();
+    manager->launchQuery(query, QStringLiteral("krunner_services"));
+    loop.exec();
+
+    manager->reset();
+    return time;
+}
+
+// Compares how long the services runner takes to come up with its first matches
+// to how long the in-process frecency provider takes to answer the same queries.
+// Both are warmed up first, so neither pays for loading anything.
+int main(int argc, char **argv)
+{
+    QCoreApplication app(argc, argv);
+
+    QStringList queries = app.arguments().mid(1);
+    if (queries.isEmpty()) {
+        queries = {QStringLiteral("sy"), QStringLiteral("sys"), QStringLiteral("system"), QStringLiteral("set"), QStringLiteral("settings")};
+    }
+    const int iterations = 20;
+
+    QTemporaryDir dir;
+    FrecencyStore store(dir.filePath(QStringLiteral("frecency")));
+    Plasma::RunnerManager manager;
+    FrecencyProvider provider(&store, &manager);
+
+    // Warm up the runner and pretend everything it found was launched, so the provider has something to offer
+    bool foundAnything = false;
+    for (const QString &query : qAsConst(queries)) {
+        QList<Plasma::QueryMatch> matches;
+        if (runnerTime(&manager, query, &matches) >= 0) {
+            foundAnything = true;
+        }
+        for (const auto &match : qAsConst(matches)) {
+            store.recordLaunch(match);
+        }
+    }
+
+    if (!foundAnything) {
+        qWarning() << "Skipping, the services runner found nothing for" << queries;
+        return 0;
+    }
+
+    QVector<Plasma::QueryMatch> providerMatches;
+    for (const QString &query : qAsConst(queries)) {
+        provider.match(query, providerMatches);
+    }
+
+    for (const QString &query : qAsConst(queries)) {
+        qint64 totalRunnerTime = 0;
+        int runnerAnswers = 0;
+        for (int i = 0; i < iterations; ++i) {
+            const qint64 time = runnerTime(&manager, query, nullptr);
+            if (time >= 0) {
+                totalRunnerTime += time;
+                ++runnerAnswers;
+            }
+        }
+
+        QElapsedTimer timer;
+        timer.start();
+        for (int i = 0; i < iterations; ++i) {
+            providerMatches.clear();
+            provider.match(query, providerMatches);
+        }
+        const qint64 providerTime = timer.nsecsElapsed() / iterations;
+
+        qDebug() << "Query" << query;
+        if (runnerAnswers > 0) {
+            qDebug() << "  First runner matches after" << totalRunnerTime / runnerAnswers / 1000 << "us";
+        } else {
+            qDebug() << "  The runner found nothing";
+        }
+        qDebug() << "  Provider answered with" << providerMatches.count() << "matches in" << providerTime / 1000.0 << "us";
+    }
+
+    return 0;
+}
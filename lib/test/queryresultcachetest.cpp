@@ -0,0 +1,258 @@
+/*
+ * This file is part of the KDE Milou Project
+ * SPDX-FileCopyrightText: 2026 Milou Authors
+ *
+ * SPDX-License-Identifier: LGPL-2.1-only OR LGPL-3.0-only OR LicenseRef-KDE-Accepted-LGPL
+ *
+ */
+
+#include <QDir>
+#include <QFile>
+#include <QStandardPaths>
+#include <QTemporaryDir>
+#include <QTest>
+
+#include "../queryresultcache.h"
+
+using namespace Milou;
+
+static StoredMatch createMatch(const QString &text)
+{
+    StoredMatch match;
+    match.runnerId = QStringLiteral("services");
+    match.id = QStringLiteral("services_") + text;
+    match.text = text;
+    match.subtext = QStringLiteral("Subtext of %1").arg(text);
+    match.iconName = text;
+    match.category = QStringLiteral("Applications");
+    match.urls = {QStringLiteral("applications:%1.desktop").arg(text)};
+    match.type = Plasma::QueryMatch::ExactMatch;
+    match.relevance = 0.8;
+    return match;
+}
+
+static QStringList texts(const QVector<StoredMatch> &matches)
+{
+    QStringList texts;
+    for (const StoredMatch &match : matches) {
+        texts.append(match.text);
+    }
+    return texts;
+}
+
+class QueryResultCacheTest : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void initTestCase();
+    void init();
+
+    void testRoundTrip();
+    void testVersioning();
+    void testConfigInvalidation();
+    void testUses();
+
+private:
+    void writeRunnerConfig(const QByteArray &contents);
+
+    QTemporaryDir m_dir;
+    QString m_fileName;
+};
+
+void QueryResultCacheTest::initTestCase()
+{
+    // The cache is tied to the krunnerrc, don't touch the real one
+    QStandardPaths::setTestModeEnabled(true);
+    QVERIFY(m_dir.isValid());
+}
+
+void QueryResultCacheTest::init()
+{
+    QFile::remove(QStandardPaths::writableLocation(QStandardPaths::ConfigLocation) + QLatin1String("/krunnerrc"));
+    m_fileName = m_dir.filePath(QString::fromLatin1(QTest::currentTestFunction()));
+}
+
+void QueryResultCacheTest::writeRunnerConfig(const QByteArray &contents)
+{
+    const QString configDir = QStandardPaths::writableLocation(QStandardPaths::ConfigLocation);
+    QDir().mkpath(configDir);
+
+    QFile config(configDir + QLatin1String("/krunnerrc"));
+    QVERIFY(config.open(QIODevice::WriteOnly));
+    config.write(contents);
+}
+
+void QueryResultCacheTest::testRoundTrip()
+{
+    {
+        QueryResultCache cache(m_fileName);
+        QVERIFY(cache.matches(QStringLiteral("fire")).isEmpty());
+
+        cache.insert(QStringLiteral("fire"), {createMatch(QStringLiteral("firefox")), createMatch(QStringLiteral("firewall"))});
+
+        QVector<StoredMatch> manyMatches;
+        for (int i = 0; i < 2 * QueryResultCache::s_maxMatchesPerQuery; ++i) {
+            manyMatches.append(createMatch(QString::number(i)));
+        }
+        cache.insert(QStringLiteral("many"), manyMatches);
+        // An empty query is never cached
+        cache.insert(QStringLiteral(" "), manyMatches);
+
+        cache.save();
+    }
+
+    QueryResultCache cache(m_fileName);
+
+    // Queries are looked up the way they were typed, apart from case and surrounding whitespace
+    const QVector<StoredMatch> matches = cache.matches(QStringLiteral(" Fire "));
+    QCOMPARE(texts(matches), QStringList({QStringLiteral("firefox"), QStringLiteral("firewall")}));
+
+    const StoredMatch &match = matches.first();
+    QCOMPARE(match.runnerId, QStringLiteral("services"));
+    QCOMPARE(match.id, QStringLiteral("services_firefox"));
+    QCOMPARE(match.subtext, QStringLiteral("Subtext of firefox"));
+    QCOMPARE(match.iconName, QStringLiteral("firefox"));
+    QCOMPARE(match.category, QStringLiteral("Applications"));
+    QCOMPARE(match.urls, QStringList({QStringLiteral("applications:firefox.desktop")}));
+    QCOMPARE(match.type, int(Plasma::QueryMatch::ExactMatch));
+    QCOMPARE(match.relevance, 0.8);
+
+    QCOMPARE(cache.matches(QStringLiteral("many")).count(), int(QueryResultCache::s_maxMatchesPerQuery));
+    QVERIFY(cache.matches(QStringLiteral(" ")).isEmpty());
+    QVERIFY(cache.matches(QStringLiteral("fir")).isEmpty());
+
+    // Updating an entry keeps the entries that weren't used in this session
+    cache.insert(QStringLiteral("fire"), {createMatch(QStringLiteral("firewall"))});
+    cache.save();
+
+    QueryResultCache updatedCache(m_fileName);
+    QCOMPARE(texts(updatedCache.matches(QStringLiteral("fire"))), QStringList({QStringLiteral("firewall")}));
+    QCOMPARE(updatedCache.matches(QStringLiteral("many")).count(), int(QueryResultCache::s_maxMatchesPerQuery));
+}
+
+void QueryResultCacheTest::testVersioning()
+{
+    {
+        QueryResultCache cache(m_fileName);
+        cache.insert(QStringLiteral("fire"), {createMatch(QStringLiteral("firefox"))});
+        cache.save();
+    }
+
+    {
+        QueryResultCache cache(m_fileName);
+        QCOMPARE(cache.matches(QStringLiteral("fire")).count(), 1);
+    }
+
+    // Pretend another version of the file format wrote it, it follows the magic
+    QFile file(m_fileName);
+    QVERIFY(file.open(QIODevice::ReadWrite));
+    QVERIFY(file.seek(sizeof(quint32)));
+    const quint32 otherVersion = 999;
+    file.write(reinterpret_cast<const char *>(&otherVersion), sizeof(otherVersion));
+    file.close();
+
+    {
+        QueryResultCache cache(m_fileName);
+        QVERIFY(cache.matches(QStringLiteral("fire")).isEmpty());
+
+        // and the file is rewritten in the current format
+        cache.insert(QStringLiteral("fire"), {createMatch(QStringLiteral("firewall"))});
+        cache.save();
+    }
+
+    {
+        QueryResultCache cache(m_fileName);
+        QCOMPARE(texts(cache.matches(QStringLiteral("fire"))), QStringList({QStringLiteral("firewall")}));
+    }
+
+    // Garbage isn't taken for a cache
+    QVERIFY(file.open(QIODevice::WriteOnly));
+    file.write(QByteArray(100, 'x'));
+    file.close();
+
+    QueryResultCache cache(m_fileName);
+    QVERIFY(cache.matches(QStringLiteral("fire")).isEmpty());
+}
+
+void QueryResultCacheTest::testConfigInvalidation()
+{
+    writeRunnerConfig("[Plugins]\nservicesEnabled=true\n");
+
+    {
+        QueryResultCache cache(m_fileName);
+        cache.insert(QStringLiteral("fire"), {createMatch(QStringLiteral("firefox"))});
+        cache.save();
+    }
+
+    {
+        QueryResultCache cache(m_fileName);
+        QCOMPARE(cache.matches(QStringLiteral("fire")).count(), 1);
+    }
+
+    // Enabling a runner may change the results of every query
+    writeRunnerConfig("[Plugins]\nservicesEnabled=true\nlocationsEnabled=true\n");
+
+    {
+        QueryResultCache cache(m_fileName);
+        QVERIFY(cache.matches(QStringLiteral("fire")).isEmpty());
+    }
+
+    // A cache written without a krunnerrc isn't valid once there is one
+    QFile::remove(QStandardPaths::writableLocation(QStandardPaths::ConfigLocation) + QLatin1String("/krunnerrc"));
+
+    {
+        QueryResultCache cache(m_fileName);
+        cache.insert(QStringLiteral("fire"), {createMatch(QStringLiteral("firefox"))});
+        cache.save();
+    }
+
+    writeRunnerConfig("[Plugins]\nservicesEnabled=true\n");
+
+    QueryResultCache cache(m_fileName);
+    QVERIFY(cache.matches(QStringLiteral("fire")).isEmpty());
+}
+
+void QueryResultCacheTest::testUses()
+{
+    {
+        QueryResultCache cache(m_fileName);
+
+        // What is typed on the way to a longer query isn't worth keeping
+        cache.insert(QStringLiteral("fi"), {createMatch(QStringLiteral("firefox"))});
+        cache.recordUse(QStringLiteral("fi"));
+        QVERIFY(cache.matches(QStringLiteral("fi")).isEmpty());
+
+        // Looking a query up over and over again doesn't make it one that is used often
+        cache.insert(QStringLiteral("fire"), {createMatch(QStringLiteral("firefox"))});
+        cache.recordUse(QStringLiteral("fire"));
+        for (int i = 0; i < 10; ++i) {
+            QCOMPARE(cache.matches(QStringLiteral("fire")).count(), 1);
+        }
+
+        // A use counts even when it was recorded before the results came in
+        for (int i = 0; i < QueryResultCache::s_maxEntries; ++i) {
+            const QString query = QStringLiteral("query %1").arg(i);
+            cache.recordUse(query);
+            cache.insert(query, {createMatch(query)});
+            cache.recordUse(query);
+        }
+
+        // A query that was used but never had results isn't kept
+        cache.recordUse(QStringLiteral("unanswered"));
+        cache.recordUse(QStringLiteral("unanswered"));
+        cache.recordUse(QStringLiteral("unanswered"));
+
+        cache.save();
+    }
+
+    QueryResultCache cache(m_fileName);
+    QVERIFY(cache.matches(QStringLiteral("fire")).isEmpty());
+    QVERIFY(cache.matches(QStringLiteral("unanswered")).isEmpty());
+    QCOMPARE(texts(cache.matches(QStringLiteral("query 0"))), QStringList{QStringLiteral("query 0")});
+    QCOMPARE(texts(cache.matches(QStringLiteral("query 199"))), QStringList{QStringLiteral("query 199")});
+}
+
+QTEST_GUILESS_MAIN(QueryResultCacheTest)
+
+#include "queryresultcachetest.moc"
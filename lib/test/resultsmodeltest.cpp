@@ -0,0 +1,408 @@
+/*
+ * This file is part of the KDE Milou Project
+ * SPDX-FileCopyrightText: 2026 Milou Authors
+ *
+ * SPDX-License-Identifier: LGPL-2.1-only OR LGPL-3.0-only OR LicenseRef-KDE-Accepted-LGPL
+ *
+ */
+
+#include <QAbstractItemModelTester>
+#include <QDebug>
+#include <QDir>
+#include <QIdentityProxyModel>
+#include <QRandomGenerator>
+#include <QSignalSpy>
+#include <QStandardItemModel>
+#include <QStandardPaths>
+#include <QTest>
+
+#include <KPluginMetaData>
+#include <KRunner/AbstractRunner>
+#include <KRunner/RunnerManager>
+
+#include "../matchprovider.h"
+#include "../resultsmodel.h"
+#include "../roledatacache.h"
+#include "../rowsnapshot.h"
+
+using namespace Milou;
+
+enum Roles {
+    SubtextRole = Qt::UserRole + 1,
+    DuplicateRole, ///< Depends on the text of the other rows, like in ResultsModel
+    CounterRole, ///< Changes on every read, must never be cached
+};
+
+// Caches its data the same way ResultsModel does
+class CachingModel : public QIdentityProxyModel
+{
+public:
+    CachingModel(int capacity = 4096)
+        : cache(new RoleDataCache(this, capacity))
+    {
+        cache->setUncachedRoles({CounterRole});
+        cache->addCrossRowDependency(Qt::DisplayRole, {DuplicateRole});
+    }
+
+    QVariant data(const QModelIndex &index, int role) const override
+    {
+        if (!index.isValid() || index.column() != 0 || !cache->isCached(role)) {
+            return uncachedData(index, role);
+        }
+
+        QVariant value;
+        if (!cache->lookup(index.row(), role, &value)) {
+            value = uncachedData(index, role);
+            cache->insert(index.row(), role, value);
+        }
+        return value;
+    }
+
+    QVariant uncachedData(const QModelIndex &index, int role) const
+    {
+        if (role == CounterRole) {
+            return ++counter;
+        }
+
+        if (role == DuplicateRole) {
+            const QVariant display = QIdentityProxyModel::data(index, Qt::DisplayRole);
+            int count = 0;
+            for (int i = 0; i < rowCount(); ++i) {
+                if (QIdentityProxyModel::data(this->index(i, 0), Qt::DisplayRole) == display) {
+                    ++count;
+                }
+            }
+            return count > 1;
+        }
+
+        return QIdentityProxyModel::data(index, role);
+    }
+
+    RoleDataCache *cache;
+    mutable int counter = 0;
+};
+
+class ResultsModelTest : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void initTestCase();
+    void init();
+    void testCacheFollowsChanges();
+    void testCacheCapacity();
+    void testResultsModel();
+    void testTypingWhileQueryRuns();
+    void testDebouncedQueryString();
+    void testRunnerRouting();
+    void testRowSnapshotVersion();
+
+private:
+    static void verifyCache(CachingModel *model);
+};
+
+void ResultsModelTest::initTestCase()
+{
+    // Keep the latencies of the test out of the real histograms
+    QStandardPaths::setTestModeEnabled(true);
+}
+
+void ResultsModelTest::init()
+{
+    // Launches and cached results of a previous test must not show up as provisional matches
+    QDir(QStandardPaths::writableLocation(QStandardPaths::GenericDataLocation) + QLatin1String("/milou")).removeRecursively();
+}
+
+// Loads the fake runner into the model, the installed runners are only loaded when there is none
+static Plasma::AbstractRunner *loadFakeRunner(ResultsModel *model)
+{
+    Plasma::RunnerManager *manager = model->runnerManager();
+    manager->loadRunner(KPluginMetaData(QStringLiteral(MILOU_FAKERUNNER_PATH)));
+    return manager->runner(QStringLiteral("milou_fakerunner"));
+}
+
+// Counts the queries it is asked about
+class CountingProvider : public MatchProvider
+{
+public:
+    void match(const QString &query, QVector<Plasma::QueryMatch> &matches) override
+    {
+        Q_UNUSED(matches)
+        queries.append(query);
+    }
+
+    QStringList queries;
+};
+
+// Comes up with a new match that looks the same every time it is asked
+class FixedProvider : public MatchProvider
+{
+public:
+    void match(const QString &query, QVector<Plasma::QueryMatch> &matches) override
+    {
+        Q_UNUSED(query)
+        Plasma::QueryMatch match(nullptr);
+        match.setId(QStringLiteral("fixed"));
+        match.setText(QStringLiteral("Fixed match"));
+        match.setSubtext(subtext);
+        match.setIconName(QStringLiteral("system-run"));
+        match.setMatchCategory(QStringLiteral("Fixed"));
+        match.setRelevance(relevance);
+        matches.append(match);
+    }
+
+    QString subtext = QStringLiteral("Subtext");
+    qreal relevance = 1;
+};
+
+static QStandardItem *createItem(QRandomGenerator *random)
+{
+    // Few distinct texts so there are duplicates
+    auto *item = new QStandardItem(QStringLiteral("Item %1").arg(random->bounded(8)));
+    item->setData(QStringLiteral("Subtext %1").arg(random->bounded(100)), SubtextRole);
+    return item;
+}
+
+void ResultsModelTest::verifyCache(CachingModel *model)
+{
+    // Read everything twice, once filling and once hitting the cache
+    for (int pass = 0; pass < 2; ++pass) {
+        for (int row = 0; row < model->rowCount(); ++row) {
+            const QModelIndex index = model->index(row, 0);
+            for (int role : {int(Qt::DisplayRole), int(SubtextRole), int(DuplicateRole)}) {
+                QCOMPARE(model->data(index, role), model->uncachedData(index, role));
+            }
+            const int counter = model->data(index, CounterRole).toInt();
+            QCOMPARE(model->data(index, CounterRole).toInt(), counter + 1);
+        }
+    }
+}
+
+void ResultsModelTest::testCacheFollowsChanges()
+{
+    QRandomGenerator random(42);
+
+    QStandardItemModel source;
+    CachingModel model;
+    model.setSourceModel(&source);
+    QAbstractItemModelTester tester(&model, QAbstractItemModelTester::FailureReportingMode::QtTest);
+
+    for (int i = 0; i < 20; ++i) {
+        source.appendRow(createItem(&random));
+    }
+    verifyCache(&model);
+
+    for (int step = 0; step < 500; ++step) {
+        const int count = source.rowCount();
+
+        switch (random.bounded(7)) {
+        case 0:
+            source.insertRow(random.bounded(count + 1), createItem(&random));
+            break;
+        case 1:
+            if (count > 0) {
+                source.removeRow(random.bounded(count));
+            }
+            break;
+        case 2:
+            // Moving a row, one row is removed and inserted elsewhere
+            if (count > 1) {
+                const QList<QStandardItem *> items = source.takeRow(random.bounded(count));
+                source.insertRow(random.bounded(count), items);
+            }
+            break;
+        case 3:
+            if (count > 0) {
+                source.item(random.bounded(count))->setText(QStringLiteral("Item %1").arg(random.bounded(8)));
+            }
+            break;
+        case 4:
+            if (count > 0) {
+                source.item(random.bounded(count))->setData(QStringLiteral("Subtext %1").arg(random.bounded(100)), SubtextRole);
+            }
+            break;
+        case 5:
+            // Sorting changes the layout
+            source.sort(0, random.bounded(2) ? Qt::AscendingOrder : Qt::DescendingOrder);
+            break;
+        case 6:
+            if (random.bounded(20) == 0) {
+                source.clear();
+                for (int i = 0; i < 20; ++i) {
+                    source.appendRow(createItem(&random));
+                }
+            }
+            break;
+        }
+
+        verifyCache(&model);
+        if (QTest::currentTestFailed()) {
+            qWarning() << "Failed in step" << step;
+            return;
+        }
+    }
+
+    QVERIFY(model.cache->hits() > 0);
+    qDebug() << "Hit rate" << model.cache->hitRate() << "with" << model.cache->hits() << "hits and" << model.cache->misses() << "misses";
+}
+
+void ResultsModelTest::testCacheCapacity()
+{
+    QStandardItemModel source;
+    for (int i = 0; i < 100; ++i) {
+        source.appendRow(new QStandardItem(QString::number(i)));
+    }
+
+    CachingModel model(10);
+    model.setSourceModel(&source);
+
+    for (int i = 0; i < 100; ++i) {
+        model.data(model.index(i, 0), Qt::DisplayRole);
+        QVERIFY(model.cache->count() <= 10);
+    }
+    QCOMPARE(model.data(model.index(99, 0), Qt::DisplayRole).toString(), QStringLiteral("99"));
+}
+
+void ResultsModelTest::testResultsModel()
+{
+    ResultsModel model;
+    QVERIFY(loadFakeRunner(&model));
+    QAbstractItemModelTester tester(&model, QAbstractItemModelTester::FailureReportingMode::QtTest);
+
+    // Type a query like a user would, all the proxies see inserts, removals and changes
+    const QString query = QStringLiteral("settings");
+    for (int i = 1; i <= query.length(); ++i) {
+        model.setQueryString(query.left(i));
+        QTRY_COMPARE(model.runnerManager()->query(), query.left(i));
+        QTRY_VERIFY(!model.querying());
+        QVERIFY(model.rowCount() > 0);
+
+        // Duplicates are never announced, they must be dropped from the cache whenever any text changes
+        QHash<QString, int> texts;
+        for (int row = 0; row < model.rowCount(); ++row) {
+            ++texts[model.index(row, 0).data().toString()];
+        }
+        for (int row = 0; row < model.rowCount(); ++row) {
+            const QModelIndex index = model.index(row, 0);
+            QCOMPARE(index.data(ResultsModel::DuplicateRole).toBool(), texts.value(index.data().toString()) > 1);
+        }
+    }
+}
+
+void ResultsModelTest::testTypingWhileQueryRuns()
+{
+    ResultsModel model;
+    Plasma::AbstractRunner *runner = loadFakeRunner(&model);
+    QVERIFY(runner);
+    // Keeps the query running long after its matches arrived
+    runner->setProperty("delay", 2000);
+
+    model.setQueryString(QStringLiteral("a"));
+    QTRY_VERIFY(model.rowCount() > 0);
+    QVERIFY(model.querying());
+
+    // The runners delivered for the query in flight, the next one isn't held back
+    model.setQueryString(QStringLiteral("ab"));
+    QCOMPARE(model.runnerManager()->query(), QStringLiteral("ab"));
+
+    // Nothing came up for the query in flight yet, the next one waits for it
+    model.setQueryString(QStringLiteral("abc"));
+    QCOMPARE(model.runnerManager()->query(), QStringLiteral("ab"));
+    QTRY_COMPARE(model.runnerManager()->query(), QStringLiteral("abc"));
+    QCOMPARE(model.skippedQueries(), 0);
+}
+
+void ResultsModelTest::testDebouncedQueryString()
+{
+    ResultsModel model;
+    QVERIFY(loadFakeRunner(&model));
+    model.setQueryDebounce(ResultsModel::FixedDebounce);
+    QSignalSpy spy(&model, &ResultsModel::queryStringChanged);
+
+    // What was typed shows up right away, while the query waits
+    model.setQueryString(QStringLiteral("se"));
+    QCOMPARE(model.queryString(), QStringLiteral("se"));
+    QCOMPARE(spy.count(), 1);
+    QCOMPARE(spy.at(0).at(0).toString(), QStringLiteral("se"));
+    QCOMPARE(model.runnerManager()->query(), QString());
+
+    // Launching it doesn't change what is shown
+    QTRY_COMPARE(model.runnerManager()->query(), QStringLiteral("se"));
+    QCOMPARE(spy.count(), 1);
+
+    // Dropping a pending query string goes back to the one that was launched
+    model.setQueryString(QStringLiteral("set"));
+    QCOMPARE(spy.count(), 2);
+    model.clear();
+    QCOMPARE(model.queryString(), QStringLiteral("se"));
+    QCOMPARE(spy.count(), 3);
+}
+
+void ResultsModelTest::testRunnerRouting()
+{
+    ResultsModel model;
+    auto *provider = new CountingProvider;
+    model.addProvider(provider);
+
+    // The triggers are built from the syntaxes of the runner once it is loaded
+    QVERIFY(loadFakeRunner(&model));
+
+    // Only the runner the prefix belongs to is asked, not the providers
+    model.setQueryString(QStringLiteral("define wording"));
+    QCOMPARE(model.routedRunner(), QStringLiteral("milou_fakerunner"));
+    QTRY_COMPARE(model.runnerManager()->query(), QStringLiteral("define wording"));
+    QTRY_VERIFY(!model.querying());
+    QVERIFY(model.rowCount() > 0);
+    QVERIFY(provider->queries.isEmpty());
+
+    // A word that only starts like the prefix is a general query
+    model.setQueryString(QStringLiteral("definitely"));
+    QCOMPARE(model.routedRunner(), QString());
+    QCOMPARE(provider->queries, QStringList{QStringLiteral("definitely")});
+
+    // As is the prefix with nothing to search for after it
+    model.setQueryString(QStringLiteral("define "));
+    QCOMPARE(model.routedRunner(), QString());
+
+    // Unless routing is off
+    model.setRunnerRouting(false);
+    model.setQueryString(QStringLiteral("define word"));
+    QCOMPARE(model.routedRunner(), QString());
+}
+
+void ResultsModelTest::testRowSnapshotVersion()
+{
+    ResultsModel model;
+    auto *provider = new FixedProvider;
+    model.addProvider(provider);
+    QVERIFY(loadFakeRunner(&model));
+
+    const auto snapshot = [&model] {
+        for (int row = 0; row < model.rowCount(); ++row) {
+            const RowSnapshot snapshot = model.index(row, 0).data(ResultsModel::RowRole).value<RowSnapshot>();
+            if (snapshot.text == QLatin1String("Fixed match")) {
+                return snapshot;
+            }
+        }
+        return RowSnapshot();
+    };
+
+    model.setQueryString(QStringLiteral("fixed"));
+    QTRY_VERIFY(!model.querying());
+    const quint64 version = snapshot().version;
+    QVERIFY(version > 0);
+
+    // A new match that looks the same keeps the version, even though QueryMatch compares by identity
+    provider->relevance = 0.5;
+    Q_EMIT provider->matchesChanged();
+    QCOMPARE(snapshot().version, version);
+
+    provider->subtext = QStringLiteral("Changed");
+    Q_EMIT provider->matchesChanged();
+    QCOMPARE(snapshot().subtext, QStringLiteral("Changed"));
+    QVERIFY(snapshot().version != version);
+}
+
+QTEST_MAIN(ResultsModelTest)
+
+#include "resultsmodeltest.moc"
@@ -0,0 +1,378 @@
+/*
+ * This file is part of the KDE Milou Project
+ * SPDX-FileCopyrightText: 2026 Milou Authors
+ *
+ * SPDX-License-Identifier: LGPL-2.1-only OR LGPL-3.0-only OR LicenseRef-KDE-Accepted-LGPL
+ *
+ */
+
+#include "tracer.h"
+
+#include "pipelinestats.h"
+#include "stallwatchdog.h"
+
+#include <QAbstractItemModel>
+#include <QCoreApplication>
+#include <QDebug>
+#include <QDir>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QStandardPaths>
+#include <QThread>
+
+using namespace Milou;
+
+Q_GLOBAL_STATIC(Tracer, s_tracer)
+
+Tracer *Tracer::instance()
+{
+    return s_tracer();
+}
+
+Tracer::Tracer()
+{
+    m_clock.start();
+
+    m_fileName = qEnvironmentVariable("MILOU_TRACE_FILE");
+    if (!m_fileName.isEmpty()) {
+        m_enabled.storeRelaxed(1);
+    } else {
+        m_fileName = QDir(QStandardPaths::writableLocation(QStandardPaths::TempLocation))
+                         .filePath(QStringLiteral("milou-trace-%1.json").arg(QCoreApplication::applicationPid()));
+    }
+}
+
+Tracer::~Tracer()
+{
+    if (isEnabled()) {
+        flush();
+    }
+    if (m_file.isOpen()) {
+        m_file.write("\n]\n");
+    }
+}
+
+void Tracer::setEnabled(bool enabled)
+{
+    m_enabled.storeRelaxed(enabled ? 1 : 0);
+}
+
+QString Tracer::fileName() const
+{
+    return m_fileName;
+}
+
+void Tracer::begin(const QByteArray &name, const char *category, const QVariantMap &args)
+{
+    if (isEnabled()) {
+        record(name, category, 'B', args);
+    }
+}
+
+void Tracer::end(const QByteArray &name, const char *category)
+{
+    if (isEnabled()) {
+        record(name, category, 'E', QVariantMap());
+    }
+}
+
+void Tracer::instant(const QByteArray &name, const char *category, const QVariantMap &args)
+{
+    if (isEnabled()) {
+        record(name, category, 'i', args);
+    }
+}
+
+void Tracer::record(const QByteArray &name, const char *category, char phase, const QVariantMap &args)
+{
+    QMutexLocker locker(&m_mutex);
+
+    if (m_events.count() >= s_maxEvents) {
+        ++m_droppedEvents;
+        return;
+    }
+
+    m_events.append(Event{name, category, phase, m_clock.nsecsElapsed(), quint64(quintptr(QThread::currentThreadId())), args});
+}
+
+QByteArray Tracer::serialize(const Event &event)
+{
+    QJsonObject object{
+        {QStringLiteral("name"), QString::fromUtf8(event.name)},
+        {QStringLiteral("cat"), QString::fromLatin1(event.category)},
+        {QStringLiteral("ph"), QString(QLatin1Char(event.phase))},
+        // Microseconds, fractions keep the nanoseconds
+        {QStringLiteral("ts"), event.timestamp / 1000.0},
+        {QStringLiteral("pid"), QCoreApplication::applicationPid()},
+        {QStringLiteral("tid"), qint64(event.threadId)},
+    };
+    if (event.phase == 'i') {
+        // Thread scoped, so it shows up next to the spans
+        object.insert(QStringLiteral("s"), QStringLiteral("t"));
+    }
+    if (!event.args.isEmpty()) {
+        object.insert(QStringLiteral("args"), QJsonObject::fromVariantMap(event.args));
+    }
+    return QJsonDocument(object).toJson(QJsonDocument::Compact);
+}
+
+bool Tracer::flush()
+{
+    QVector<Event> events;
+    int droppedEvents = 0;
+    {
+        QMutexLocker locker(&m_mutex);
+        events.swap(m_events);
+        droppedEvents = m_droppedEvents;
+        m_droppedEvents = 0;
+    }
+
+    if (droppedEvents > 0) {
+        events.append(Event{QByteArrayLiteral("dropped events"), "trace", 'i', m_clock.nsecsElapsed(), quint64(quintptr(QThread::currentThreadId())),
+                            {{QStringLiteral("count"), droppedEvents}}});
+    }
+    if (events.isEmpty()) {
+        return true;
+    }
+
+    QMutexLocker locker(&m_fileMutex);
+
+    // The trace of this process replaces any earlier one, then it is only appended to
+    if (!m_file.isOpen()) {
+        m_file.setFileName(m_fileName);
+        if (!m_file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+            qWarning() << "Failed to write trace to" << m_fileName << m_file.errorString();
+            return false;
+        }
+        // The JSON array format, the closing bracket is optional so events can be appended
+        m_file.write("[\n");
+    }
+
+    QByteArray data;
+    for (const Event &event : qAsConst(events)) {
+        if (m_hasWrittenEvents) {
+            data += ",\n";
+        }
+        data += serialize(event);
+        m_hasWrittenEvents = true;
+    }
+
+    const bool written = m_file.write(data) == data.size();
+    return m_file.flush() && written;
+}
+
+Tracer::Span::Span(const char *name, const char *category, const QVariantMap &args)
+    : m_name(name)
+    , m_category(category)
+    , m_recording(Tracer::instance()->isEnabled())
+{
+    if (m_recording) {
+        Tracer::instance()->begin(QByteArray::fromRawData(m_name, qstrlen(m_name)), m_category, args);
+    }
+}
+
+Tracer::Span::~Span()
+{
+    // Also end a span when tracing was turned off in the meantime so begin and end match up
+    if (m_recording) {
+        Tracer::instance()->record(QByteArray::fromRawData(m_name, qstrlen(m_name)), m_category, 'E', QVariantMap());
+    }
+}
+
+StageProbe *StageProbe::s_timedStage = nullptr;
+
+StageProbe::StageProbe(QAbstractItemModel *model, const QByteArray &stage, PipelineStats *stats, QAbstractItemModel *source)
+    : QObject(model)
+    , m_stage(stage)
+    , m_source(source)
+    , m_stats(stats)
+{
+    if (m_stats) {
+        m_statsStage = m_stats->addStage(QString::fromLatin1(stage), model);
+    }
+
+    connect(model, &QAbstractItemModel::rowsAboutToBeInserted, this, [this] {
+        begin("insert");
+    });
+    connect(model, &QAbstractItemModel::rowsInserted, this, [this] {
+        end("insert");
+    });
+    connect(model, &QAbstractItemModel::rowsAboutToBeRemoved, this, [this] {
+        begin("remove");
+    });
+    connect(model, &QAbstractItemModel::rowsRemoved, this, [this] {
+        end("remove");
+    });
+    connect(model, &QAbstractItemModel::rowsAboutToBeMoved, this, [this] {
+        begin("move");
+    });
+    connect(model, &QAbstractItemModel::rowsMoved, this, [this] {
+        end("move");
+    });
+    connect(model, &QAbstractItemModel::layoutAboutToBeChanged, this, [this] {
+        begin("layout");
+    });
+    connect(model, &QAbstractItemModel::layoutChanged, this, [this] {
+        end("layout");
+    });
+    connect(model, &QAbstractItemModel::modelAboutToBeReset, this, [this] {
+        begin("reset");
+    });
+    connect(model, &QAbstractItemModel::modelReset, this, [this] {
+        end("reset");
+    });
+    // There is no signal before data changes, only mark when it happened
+    connect(model, &QAbstractItemModel::dataChanged, this, [this](const QModelIndex &topLeft, const QModelIndex &bottomRight) {
+        if (m_stats) {
+            m_stats->addChange(m_statsStage, false);
+        }
+        if (Tracer::instance()->isEnabled()) {
+            Tracer::instance()->instant(m_stage + " dataChanged",
+                                        "model",
+                                        {{QStringLiteral("rows"), bottomRight.row() - topLeft.row() + 1}});
+        }
+    });
+
+    if (!m_source) {
+        return;
+    }
+
+    // Connected before the proxy, so these run right before it handles a change
+    const auto beginHandlingOn = [this](auto signal, const char *change) {
+        connect(m_source, signal, this, [this, change] {
+            beginHandling(change);
+        });
+    };
+    beginHandlingOn(&QAbstractItemModel::rowsAboutToBeInserted, "insert");
+    beginHandlingOn(&QAbstractItemModel::rowsInserted, "insert");
+    beginHandlingOn(&QAbstractItemModel::rowsAboutToBeRemoved, "remove");
+    beginHandlingOn(&QAbstractItemModel::rowsRemoved, "remove");
+    beginHandlingOn(&QAbstractItemModel::rowsAboutToBeMoved, "move");
+    beginHandlingOn(&QAbstractItemModel::rowsMoved, "move");
+    beginHandlingOn(&QAbstractItemModel::layoutAboutToBeChanged, "layout");
+    beginHandlingOn(&QAbstractItemModel::layoutChanged, "layout");
+    beginHandlingOn(&QAbstractItemModel::modelAboutToBeReset, "reset");
+    beginHandlingOn(&QAbstractItemModel::modelReset, "reset");
+    beginHandlingOn(&QAbstractItemModel::dataChanged, "dataChanged");
+}
+
+StageProbe::~StageProbe()
+{
+    if (s_timedStage == this) {
+        s_timedStage = m_outerStage;
+    }
+}
+
+void StageProbe::sourceConnected()
+{
+    if (!m_source) {
+        return;
+    }
+
+    // Connected after the proxy, so these run right after it handled a change
+    const auto endHandlingOn = [this](auto signal, const char *change) {
+        connect(m_source, signal, this, [this, change] {
+            endHandling(change);
+        });
+    };
+    endHandlingOn(&QAbstractItemModel::rowsAboutToBeInserted, "insert");
+    endHandlingOn(&QAbstractItemModel::rowsInserted, "insert");
+    endHandlingOn(&QAbstractItemModel::rowsAboutToBeRemoved, "remove");
+    endHandlingOn(&QAbstractItemModel::rowsRemoved, "remove");
+    endHandlingOn(&QAbstractItemModel::rowsAboutToBeMoved, "move");
+    endHandlingOn(&QAbstractItemModel::rowsMoved, "move");
+    endHandlingOn(&QAbstractItemModel::layoutAboutToBeChanged, "layout");
+    endHandlingOn(&QAbstractItemModel::layoutChanged, "layout");
+    endHandlingOn(&QAbstractItemModel::modelAboutToBeReset, "reset");
+    endHandlingOn(&QAbstractItemModel::modelReset, "reset");
+    endHandlingOn(&QAbstractItemModel::dataChanged, "dataChanged");
+}
+
+void StageProbe::begin(const char *change)
+{
+    // A stage with a source is timed while it handles the changes of the source, which announces these
+    if (m_depth++ == 0 && !m_source) {
+        startTiming();
+    }
+
+    if (Tracer::instance()->isEnabled()) {
+        Tracer::instance()->begin(m_stage + ' ' + change, "model");
+    }
+}
+
+void StageProbe::end(const char *change)
+{
+    if (Tracer::instance()->isEnabled()) {
+        Tracer::instance()->end(m_stage + ' ' + change, "model");
+    }
+
+    if (m_depth == 0) {
+        return;
+    }
+    if (--m_depth == 0) {
+        if (m_stats) {
+            m_stats->addChange(m_statsStage, qstrcmp(change, "layout") == 0);
+        }
+        if (!m_source) {
+            stopTiming(change);
+        } else if (m_handlingDepth > 0 && m_ownTime < 0) {
+            m_ownTime = m_timer.nsecsElapsed() - m_innerTime;
+        }
+    }
+}
+
+void StageProbe::beginHandling(const char *change)
+{
+    if (m_handlingDepth++ == 0) {
+        startTiming();
+    }
+
+    if (Tracer::instance()->isEnabled()) {
+        Tracer::instance()->begin(m_stage + " handling " + change, "model");
+    }
+}
+
+void StageProbe::endHandling(const char *change)
+{
+    if (Tracer::instance()->isEnabled()) {
+        Tracer::instance()->end(m_stage + " handling " + change, "model");
+    }
+
+    if (m_handlingDepth == 0) {
+        return;
+    }
+    if (--m_handlingDepth == 0) {
+        stopTiming(change);
+    }
+}
+
+void StageProbe::startTiming()
+{
+    m_timer.start();
+    m_innerTime = 0;
+    m_ownTime = -1;
+    m_outerStage = s_timedStage;
+    s_timedStage = this;
+}
+
+void StageProbe::stopTiming(const char *change)
+{
+    const qint64 nsecs = m_timer.nsecsElapsed();
+    const qint64 ownTime = m_ownTime >= 0 ? m_ownTime : nsecs - m_innerTime;
+
+    s_timedStage = m_outerStage;
+    if (m_outerStage) {
+        m_outerStage->m_innerTime += nsecs;
+    }
+
+    if (m_stats) {
+        m_stats->addTime(m_statsStage, ownTime);
+    }
+    if (StallWatchdog::instance()->isEnabled()) {
+        StallWatchdog::instance()->check(m_stage + ' ' + change, ownTime, qobject_cast<QAbstractItemModel *>(parent()));
+        // Blocking for long in small parts spread over the stages is a stall too
+        if (!m_outerStage && nsecs > ownTime) {
+            StallWatchdog::instance()->check(m_stage + ' ' + change + " and the stages below", nsecs, qobject_cast<QAbstractItemModel *>(parent()));
+        }
+    }
+}
@@ -0,0 +1,163 @@
+/*
+ * This file is part of the KDE Milou Project
+ * SPDX-FileCopyrightText: 2026 Milou Authors
+ *
+ * SPDX-License-Identifier: LGPL-2.1-only OR LGPL-3.0-only OR LicenseRef-KDE-Accepted-LGPL
+ *
+ */
+
+#pragma once
+
+#include <QAtomicInteger>
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QMutex>
+#include <QObject>
+#include <QVariantMap>
+#include <QVector>
+
+class QAbstractItemModel;
+
+namespace Milou
+{
+class PipelineStats;
+
+/**
+ * Records what happens during a query as Chrome trace events
+ *
+ * Tracing is off unless the MILOU_TRACE_FILE environment variable names
+ * the file to write the trace to, or it is enabled through
+ * ResultsModel::tracing, in which case it is written to the temporary
+ * directory. The file opens in Perfetto or chrome://tracing. Events are
+ * appended to it whenever a query finished, when tracing is turned off and
+ * at exit, so writing it only costs what was recorded since.
+ *
+ * While tracing is off recording an event costs little more than an atomic load.
+ */
+class Tracer
+{
+public:
+    static Tracer *instance();
+
+    bool isEnabled() const
+    {
+        return m_enabled.loadRelaxed();
+    }
+    void setEnabled(bool enabled);
+
+    QString fileName() const;
+
+    void begin(const QByteArray &name, const char *category, const QVariantMap &args = QVariantMap());
+    void end(const QByteArray &name, const char *category);
+    void instant(const QByteArray &name, const char *category, const QVariantMap &args = QVariantMap());
+
+    /**
+     * Appends the events recorded since the last flush to fileName()
+     */
+    bool flush();
+
+    /**
+     * Records the lifetime of the span as a begin and an end event
+     */
+    class Span
+    {
+    public:
+        Span(const char *name, const char *category, const QVariantMap &args = QVariantMap());
+        ~Span();
+
+    private:
+        const char *m_name;
+        const char *m_category;
+        bool m_recording;
+    };
+
+    Tracer();
+    ~Tracer();
+
+private:
+    struct Event {
+        QByteArray name;
+        const char *category;
+        char phase;
+        qint64 timestamp; // nanoseconds since the tracer was created
+        quint64 threadId;
+        QVariantMap args;
+    };
+
+    void record(const QByteArray &name, const char *category, char phase, const QVariantMap &args);
+    static QByteArray serialize(const Event &event);
+
+    // Keeps memory in check when events aren't flushed for a long time
+    static constexpr int s_maxEvents = 500000;
+
+    QAtomicInteger<int> m_enabled = 0;
+    QString m_fileName;
+
+    QMutex m_mutex;
+    QElapsedTimer m_clock;
+    // Recorded since the last flush
+    QVector<Event> m_events;
+    int m_droppedEvents = 0;
+
+    QMutex m_fileMutex;
+    QFile m_file;
+    bool m_hasWrittenEvents = false;
+};
+
+/**
+ * Traces the changes of a stage of the models as spans and counts them in the PipelineStats
+ *
+ * A span starts when the model announces a change, e.g. with rowsAboutToBeInserted,
+ * and ends when the change is done. A proxy does most of its work before it announces
+ * anything, filtering, sorting and mapping the rows while it handles a change of its
+ * source, so for a proxy the probe also spans handling each change of the source.
+ * It needs to be created before the proxy connects to its source and be told once it
+ * did, see sourceConnected().
+ *
+ * The time counted for a stage is that of handling the changes of its source, or of its
+ * own changes if it has no source. As the stages further down the chain handle a change
+ * while it is being announced, their time is left out, as is the time others like the
+ * views spend on the changes the stage announced.
+ */
+class StageProbe : public QObject
+{
+    Q_OBJECT
+
+public:
+    StageProbe(QAbstractItemModel *model, const QByteArray &stage, PipelineStats *stats = nullptr, QAbstractItemModel *source = nullptr);
+    ~StageProbe() override;
+
+    /**
+     * Call once the proxy connected to its source, so its handling of the changes can be timed
+     */
+    void sourceConnected();
+
+private:
+    void begin(const char *change);
+    void end(const char *change);
+    void beginHandling(const char *change);
+    void endHandling(const char *change);
+
+    void startTiming();
+    void stopTiming(const char *change);
+
+    QByteArray m_stage;
+    QAbstractItemModel *m_source;
+
+    PipelineStats *m_stats;
+    int m_statsStage = -1;
+    // Changes may be announced while another one is in progress, only the outermost is timed
+    int m_depth = 0;
+    int m_handlingDepth = 0;
+
+    QElapsedTimer m_timer;
+    // The stage that was being timed when this one started, it doesn't count the time of this one
+    StageProbe *m_outerStage = nullptr;
+    qint64 m_innerTime = 0;
+    // Time of the stage when it announced that its change is done, what follows is the others'
+    qint64 m_ownTime = -1;
+    static StageProbe *s_timedStage;
+};
+
+} // namespace Milou
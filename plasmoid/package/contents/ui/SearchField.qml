@@ -12,9 +12,8 @@ import org.kde.plasma.components 2.0 as PlasmaComponents
 import "globals.js" as Globals
 
 /*
- * The SearchField is a simple text field widget. The only complex part
- * is the internal timer to reduce the number of textChanged signals
- * using searchTextChanged.
+ * The SearchField is a simple text field widget. It reports every change
+ * of the text, the ResultsModel decides when to actually run the query.
  */
 Item {
     signal searchTextChanged()
@@ -37,15 +36,7 @@ Item {
         focus: true
         Keys.forwardTo: listView
 
-        // We do not want to send the text instantly as that would result
-        // in too many queries. Therefore we add a small 200msec delay
-        Timer {
-            id: timer
-            interval: 200
-            onTriggered: searchTextChanged()
-        }
-
-        onTextChanged: timer.restart()
+        onTextChanged: searchTextChanged()
     }
 
     function selectAll() {
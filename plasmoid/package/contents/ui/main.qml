@@ -12,7 +12,7 @@ import QtQuick.Layouts 1.1
 import org.kde.plasma.plasmoid 2.0
 
 import org.kde.plasma.core 2.0 as PlasmaCore
-import org.kde.milou 0.1 as Milou
+import org.kde.milou 0.3 as Milou
 
 import "globals.js" as Globals
 
@@ -22,9 +22,18 @@ Item {
     Plasmoid.switchHeight: Globals.SwitchWidth
     Layout.minimumWidth: Globals.PlasmoidWidth
     Layout.maximumWidth: Globals.PlasmoidWidth
-    Layout.minimumHeight: wrapper.minimumHeight + wrapper.anchors.topMargin + wrapper.anchors.bottomMargin
+    Layout.minimumHeight: heightSettler.settledHeight
     Layout.maximumHeight: Layout.minimumHeight
 
+    // Resizing the popup for every result that comes in is expensive
+    Milou.HeightSettler {
+        id: heightSettler
+        targetHeight: wrapper.minimumHeight + wrapper.anchors.topMargin + wrapper.anchors.bottomMargin
+        quantum: PlasmaCore.Units.gridUnit
+        // Don't have the popup jump around while the results of a query are coming in
+        growOnly: listView.querying
+    }
+
     function isBottomEdge() {
         return plasmoid.location == PlasmaCore.Types.BottomEdge;
     }
@@ -47,6 +56,7 @@ Item {
                 verticalCenter: parent.height / 2
             }
             onSearchTextChanged: {
+                heightSettler.reset()
                 listView.setQueryString(text)
             }
             onClose: plasmoid.expanded = false
@@ -63,6 +73,7 @@ Item {
             }
 
             reversed: isBottomEdge()
+            queryDebounce: Milou.ResultsModel.AdaptiveDebounce
             onActivated: {
                 searchField.text = "";
                 plasmoid.expanded = false;
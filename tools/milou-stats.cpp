@@ -0,0 +1,90 @@
+/*
+ * This file is part of the KDE Milou Project
+ * SPDX-FileCopyrightText: 2026 Milou Authors
+ *
+ * SPDX-License-Identifier: LGPL-2.1-only OR LGPL-3.0-only OR LicenseRef-KDE-Accepted-LGPL
+ *
+ */
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QTextStream>
+
+#include "latencyhistograms.h"
+
+using namespace Milou;
+
+static QString formatLatency(qreal msecs)
+{
+    if (msecs < 0) {
+        return QStringLiteral("-");
+    }
+    return QStringLiteral("<%1ms").arg(msecs, 0, 'f', msecs < 10 ? 1 : 0);
+}
+
+int main(int argc, char **argv)
+{
+    QCoreApplication app(argc, argv);
+    app.setApplicationName(QStringLiteral("milou-stats"));
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription(QStringLiteral("Prints the latencies Milou recorded on this machine"));
+    parser.addHelpOption();
+    QCommandLineOption fileOption(QStringLiteral("file"), QStringLiteral("The histograms to read"), QStringLiteral("path"), LatencyHistograms::defaultFileName());
+    parser.addOption(fileOption);
+    QCommandLineOption bucketsOption(QStringLiteral("buckets"), QStringLiteral("Print the buckets as well"));
+    parser.addOption(bucketsOption);
+    QCommandLineOption resetOption(QStringLiteral("reset"), QStringLiteral("Forget the recorded latencies"));
+    parser.addOption(resetOption);
+    parser.process(app);
+
+    QTextStream out(stdout);
+    QTextStream err(stderr);
+
+    LatencyHistograms histograms(parser.value(fileOption));
+    // Never start over with the file, the latencies may be recorded by another version
+    if (!histograms.openExisting(parser.isSet(resetOption))) {
+        err << "No latencies recorded in " << parser.value(fileOption) << Qt::endl;
+        return 1;
+    }
+
+    if (parser.isSet(resetOption)) {
+        histograms.reset();
+        return 0;
+    }
+
+    const QList<qreal> percentiles{50, 90, 95, 99};
+
+    out << qSetFieldWidth(28) << Qt::left << "metric" << qSetFieldWidth(10) << Qt::right << "count";
+    for (qreal percentile : percentiles) {
+        out << QStringLiteral("p%1").arg(percentile);
+    }
+    out << "max" << qSetFieldWidth(0) << Qt::endl;
+
+    for (int i = 0; i < LatencyHistograms::s_metricCount; ++i) {
+        const auto metric = LatencyHistograms::Metric(i);
+
+        out << qSetFieldWidth(28) << Qt::left << LatencyHistograms::metricName(metric) << qSetFieldWidth(10) << Qt::right << histograms.count(metric);
+        for (qreal percentile : percentiles) {
+            out << formatLatency(histograms.percentile(metric, percentile));
+        }
+        out << formatLatency(histograms.percentile(metric, 100)) << qSetFieldWidth(0) << Qt::endl;
+    }
+
+    if (parser.isSet(bucketsOption)) {
+        for (int i = 0; i < LatencyHistograms::s_metricCount; ++i) {
+            const auto metric = LatencyHistograms::Metric(i);
+            const QVector<quint32> buckets = histograms.buckets(metric);
+
+            out << Qt::endl << LatencyHistograms::metricName(metric) << Qt::endl;
+            for (int bucket = 0; bucket < buckets.count(); ++bucket) {
+                if (buckets.at(bucket) > 0) {
+                    out << qSetFieldWidth(12) << formatLatency(LatencyHistograms::bucketUpperBound(bucket)) << buckets.at(bucket) << qSetFieldWidth(0)
+                        << Qt::endl;
+                }
+            }
+        }
+    }
+
+    return 0;
+}